@@ -2,26 +2,300 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
+#include <cmath>
+#include <memory_resource>
+#include <bit>
+#include <utility>
+#include <cstdint>
+#ifdef USE_THREADS
+#include <numeric>
+#endif
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
+#include "tokenizer.h"
+#ifdef USE_STREAMING
+#include "record_stream.h"
+#endif
+#ifdef USE_THREADS
+#include "thread_pool.h"
+#endif
+#ifdef USE_EXTERNAL_SORT
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <filesystem>
+#include <random>
+#include <atomic>
+#endif
+
+
+struct input_data {
+    std::vector<int> left_list;
+    std::vector<int> right_list;
+};
+
+#ifndef USE_STD_SORT
+// put the given ids in ascending order in sorted, using scratch as working
+// space; the location ids occupy a narrow range (5 digits in my input), so
+// this is a counting sort if the range is no bigger than the number of ids,
+// otherwise an LSD radix sort on just the bits that vary, 11 bits at a time:
+// two passes over the data for ranges up to 2^22, and O(n) rather than O(n log n)
+void sort_ids(const std::vector<int> & ids, std::pmr::vector<int> & sorted, std::pmr::vector<int> & scratch)
+{
+    sorted.resize(ids.size());
+    if (ids.empty())
+        return;
+    const auto [lowest, highest] = std::ranges::minmax(ids);
+    // (unsigned arithmetic, so that any range of ints works)
+    const uint32_t base = static_cast<uint32_t>(lowest);
+    const uint32_t range = static_cast<uint32_t>(highest) - base;
+    auto key = [base](int id) { return static_cast<uint32_t>(id) - base; };
+
+    std::pmr::memory_resource * memory = sorted.get_allocator().resource();
+    if (range < ids.size()) {
+        std::pmr::vector<uint32_t> count(range + 1, 0, memory);
+        for (const int id : ids)
+            ++count[key(id)];
+        auto out = sorted.begin();
+        for (uint32_t k = 0; k <= range; ++k)
+            out = std::fill_n(out, count[k], static_cast<int>(base + k));
+        return;
+    }
+
+    constexpr unsigned digit_bits = 11;
+    constexpr uint32_t digit_values = 1 << digit_bits;
+    const unsigned passes = (std::bit_width(range) + digit_bits - 1) / digit_bits;
+
+    // count the occurrences of every digit value in every pass in one go
+    std::pmr::vector<uint32_t> count(passes * digit_values, 0, memory);
+    for (const int id : ids)
+        for (unsigned pass = 0; pass < passes; ++pass)
+            ++count[pass * digit_values + ((key(id) >> (pass * digit_bits)) & (digit_values - 1))];
+
+    // the passes ping-pong between sorted and scratch, ending in sorted; the
+    // first reads straight from ids, so they're never copied
+    scratch.resize(ids.size());
+    const int * from = ids.data();
+    int * to = (passes & 1) ? sorted.data() : scratch.data();
+    int * spare = (passes & 1) ? scratch.data() : sorted.data();
+    for (unsigned pass = 0; pass < passes; ++pass) {
+        uint32_t * offset = &count[pass * digit_values];
+        for (uint32_t d = 0, total = 0; d < digit_values; ++d)
+            total += std::exchange(offset[d], total);
+        const unsigned shift = pass * digit_bits;
+        for (size_t i = 0; i < ids.size(); ++i)
+            to[offset[(key(from[i]) >> shift) & (digit_values - 1)]++] = from[i];
+        from = to;
+        std::swap(to, spare);
+    }
+}
+#endif
 
 
-void solve(std::vector<int> left_list, std::vector<int> right_list,
-    int_least64_t & total_distance, int_least64_t & similarity_score)
+#ifdef USE_THREADS
+// return the number of shares to split n items into: enough that each gets
+// at least min_per_thread of them, but no more than the pool has threads
+unsigned threads_for(size_t n, size_t min_per_thread = 1 << 16)
+{
+    return static_cast<unsigned>(std::clamp<size_t>(n / min_per_thread, 1, shared_thread_pool().size()));
+}
+
+// return the [first, last) indexes of thread t's share of n items
+std::pair<size_t, size_t> share(size_t n, unsigned t, unsigned threads)
+{
+    return {n * t / threads, n * (t + 1) / threads};
+}
+
+// sort_ids() in the given number of shares on the thread pool: each pass of
+// the radix sort has every share's digits counted, then works out where each
+// share's ids go (after those of the same digit from earlier shares), then
+// has every share put its ids there, so the sort stays stable
+void parallel_sort_ids(const std::vector<int> & ids, std::pmr::vector<int> & sorted,
+    std::pmr::vector<int> & scratch, unsigned threads)
+{
+    if (threads < 2) {
+        sort_ids(ids, sorted, scratch);
+        return;
+    }
+    const size_t n = ids.size();
+    sorted.resize(n);
+    scratch.resize(n);
+
+    thread_pool & pool = shared_thread_pool();
+    std::vector<std::pair<int, int>> ranges(threads, {0, -1});
+    pool.for_each(threads, [&](unsigned t) {
+        const auto [first, last] = share(n, t, threads);
+        if (first != last) {
+            const auto [lowest, highest] = std::minmax_element(ids.begin() + first, ids.begin() + last);
+            ranges[t] = {*lowest, *highest};
+        }
+    });
+    int lowest = 0, highest = 0;
+    bool any = false;
+    for (const auto & [lo, hi] : ranges) {
+        if (hi < lo)
+            continue; // (an empty share)
+        lowest = any ? std::min(lowest, lo) : lo;
+        highest = any ? std::max(highest, hi) : hi;
+        any = true;
+    }
+    const uint32_t base = static_cast<uint32_t>(lowest);
+    const uint32_t range = static_cast<uint32_t>(highest) - base;
+
+    constexpr unsigned digit_bits = 11;
+    constexpr uint32_t digit_values = 1 << digit_bits;
+    const unsigned passes = std::max(1u, (std::bit_width(range) + digit_bits - 1) / digit_bits);
+
+    std::pmr::vector<uint32_t> count(threads * digit_values, sorted.get_allocator().resource());
+    const int * from = ids.data();
+    int * to = (passes & 1) ? sorted.data() : scratch.data();
+    int * spare = (passes & 1) ? scratch.data() : sorted.data();
+    for (unsigned pass = 0; pass < passes; ++pass) {
+        const unsigned shift = pass * digit_bits;
+        auto digit = [&](int id) { return ((static_cast<uint32_t>(id) - base) >> shift) & (digit_values - 1); };
+
+        pool.for_each(threads, [&](unsigned t) {
+            const auto [first, last] = share(n, t, threads);
+            uint32_t * offset = &count[t * digit_values];
+            std::fill(offset, offset + digit_values, 0);
+            for (size_t i = first; i < last; ++i)
+                ++offset[digit(from[i])];
+        });
+        // turn the counts into where each share's first id with each digit goes
+        for (uint32_t d = 0, total = 0; d < digit_values; ++d)
+            for (unsigned t = 0; t < threads; ++t)
+                total += std::exchange(count[t * digit_values + d], total);
+        pool.for_each(threads, [&](unsigned t) {
+            const auto [first, last] = share(n, t, threads);
+            uint32_t * offset = &count[t * digit_values];
+            for (size_t i = first; i < last; ++i)
+                to[offset[digit(from[i])]++] = from[i];
+        });
+        from = to;
+        std::swap(to, spare);
+    }
+}
+#endif
+
+
+// return the sum of |a[i] - b[i]| for i in [0, n)
+int_least64_t sum_of_distances(const int * a, const int * b, size_t n)
+{
+    int_least64_t total = 0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        const __m256i difference = _mm256_abs_epi32(_mm256_sub_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))));
+        // (widen to 64 bits before adding so the sum can't overflow)
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(difference)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(difference, 1)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sum);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE4_1__)
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        const __m128i difference = _mm_abs_epi32(_mm_sub_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))));
+        sum = _mm_add_epi64(sum, _mm_cvtepu32_epi64(difference));
+        sum = _mm_add_epi64(sum, _mm_cvtepu32_epi64(_mm_srli_si128(difference, 8)));
+    }
+    total = _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1);
+#endif
+    for (; i < n; ++i)
+        total += std::abs(a[i] - b[i]);
+    return total;
+}
+
+
+#ifndef USE_MAP
+// return the sum of each id in left[first, last) times the number of times
+// it appears in right (both sorted)
+int_least64_t similarity(const std::pmr::vector<int> & left, size_t first, size_t last, const std::pmr::vector<int> & right)
+{
+    int_least64_t score = 0;
+    if (first == last)
+        return score;
+    size_t iright = std::ranges::lower_bound(right, left[first]) - right.begin();
+    const size_t iright_end = right.size();
+    int right_count = 0; // (the number of times the previous left appears in the right list)
+    for (size_t ileft = first; ileft < last; ++ileft) {
+        const int left_id = left[ileft];
+        if (ileft == first || left_id != left[ileft - 1]) {
+            // (a repeated left id scores the same again; the right ids it matched have already been passed)
+            while (iright < iright_end && left_id > right[iright])
+                ++iright;
+            if (iright == iright_end)
+                break;
+            const size_t iright_start = iright;
+            while (iright < iright_end && left_id == right[iright])
+                ++iright;
+            right_count = iright - iright_start;
+        }
+        score += static_cast<int_least64_t>(left_id) * right_count;
+    }
+    return score;
+}
+#endif
+
+
+void solve(const input_data & input, int_least64_t & total_distance, int_least64_t & similarity_score)
 {
     total_distance = similarity_score = 0;
 
+    // (the sorted lists are kept in the arena rather than sorting copies of the input)
+    scratch_arena arena;
+    std::pmr::vector<int> left_list(&arena);
+    std::pmr::vector<int> right_list(&arena);
+
     // part 1
+    perf_part("part 1");
+
+#ifdef USE_THREADS
+    // (each thread takes an equal share of the sorted lists in both parts)
+    const unsigned threads = threads_for(input.left_list.size());
+    std::vector<int_least64_t> partial_sums(threads);
+#endif
 
+#if defined(USE_STD_SORT)
+    left_list.assign(input.left_list.begin(), input.left_list.end());
+    right_list.assign(input.right_list.begin(), input.right_list.end());
     std::ranges::sort(left_list);
     std::ranges::sort(right_list);
-    for (int i = 0; i < left_list.size(); ++i)
-        total_distance += std::abs(left_list[i] - right_list[i]);
+#elif defined(USE_THREADS)
+    std::pmr::vector<int> scratch(&arena);
+    parallel_sort_ids(input.left_list, left_list, scratch, threads);
+    parallel_sort_ids(input.right_list, right_list, scratch, threads);
+#else
+    std::pmr::vector<int> scratch(&arena);
+    sort_ids(input.left_list, left_list, scratch);
+    sort_ids(input.right_list, right_list, scratch);
+#endif
+#ifdef USE_THREADS
+    shared_thread_pool().for_each(threads, [&](unsigned t) {
+        const auto [first, last] = share(left_list.size(), t, threads);
+        partial_sums[t] = sum_of_distances(left_list.data() + first, right_list.data() + first, last - first);
+    });
+    total_distance = std::accumulate(partial_sums.begin(), partial_sums.end(), int_least64_t{0});
+#else
+    total_distance = sum_of_distances(left_list.data(), right_list.data(), left_list.size());
+#endif
 
     // part 2
+    perf_part("part 2");
 
 #ifdef USE_MAP
     std::unordered_map<int, int> right_unique_count;
@@ -30,47 +304,520 @@ void solve(std::vector<int> left_list, std::vector<int> right_list,
     for (const int left : left_list)
         if (right_unique_count.contains(left))
             similarity_score += static_cast<int_least64_t>(left) * right_unique_count[left];
+#elif defined(USE_THREADS)
+    shared_thread_pool().for_each(threads, [&](unsigned t) {
+        const auto [first, last] = share(left_list.size(), t, threads);
+        partial_sums[t] = similarity(left_list, first, last, right_list);
+    });
+    similarity_score = std::accumulate(partial_sums.begin(), partial_sums.end(), int_least64_t{0});
 #else
-    int iright = 0;
-    const int iright_end = right_list.size();
-    for (const int left : left_list) {
-        while (iright < iright_end && left > right_list[iright])
-            ++iright;
-        if (iright == iright_end)
-            break;
-        const int iright_start = iright;
-        while (iright < iright_end && left == right_list[iright])
-            ++iright;
-        similarity_score += static_cast<int_least64_t>(left) * (iright - iright_start);
+    similarity_score = similarity(left_list, 0, left_list.size(), right_list);
+#endif
+}
+
+
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
+{
+    std::vector<int> numbers;
+    tokenize_numbers(text, numbers);
+    for (unsigned i = 0; i + 1 < numbers.size(); i += 2) {
+        input.left_list.push_back(numbers[i]);
+        input.right_list.push_back(numbers[i + 1]);
     }
+    return true;
+}
+
+
+#ifdef USE_STREAMING
+// read the puzzle input text on a reader thread while the lists are built on
+// this one, then solve; unlike the other streaming days there's nothing to
+// work out until every number has been read, because both parts need the
+// complete lists, so only the parsing overlaps; return false if the input
+// isn't as expected
+bool solve_streaming(std::string_view text, int_least64_t & total_distance, int_least64_t & similarity_score)
+{
+    input_data input;
+    const bool input_ok = stream_records<std::pair<int, int>>(text,
+        [](std::string_view line, std::pair<int, int> & pair) {
+            return next_number(line, pair.first) && next_number(line, pair.second);
+        },
+        [&](const std::pair<int, int> & pair) {
+            input.left_list.push_back(pair.first);
+            input.right_list.push_back(pair.second);
+        });
+    solve(input, total_distance, similarity_score);
+    return input_ok;
+}
 #endif
+
+
+#ifdef USE_INCREMENTAL
+// both lists kept up to date one id at a time, with both answers always ready
+//
+// Part 2 is easy: the similarity score is the sum over every id v of
+// v * (times v is in the left list) * (times v is in the right list), so
+// adding or removing a left v changes it by v times the right count of v,
+// and vice versa, in O(1).
+//
+// Part 1 is harder because adding one id shifts the pairing of every larger
+// id. But |a - b| is the number of integers x with min(a, b) <= x < max(a, b),
+// so with D(x) = (left ids <= x) - (right ids <= x) the total distance is the
+// sum over all x of |D(x)|. Adding a left id v adds 1 to D(x) for every
+// x >= v, which changes the sum by (the number of those x with D(x) >= 0)
+// minus (the number with D(x) < 0). D is kept in sqrt(id_limit) blocks, each
+// with a pending amount to add to the whole block, a histogram of its
+// values and a count of how many are negative, so an update costs
+// O(sqrt(id_limit)), not O(id_limit). (I don't know of a structure that does
+// range add with sum of absolute values in logarithmic time.) The total
+// distance is only meaningful when the lists are the same length, as they
+// are in the puzzle.
+class location_lists {
+public:
+    // the ids must be in [0, id_limit); my input has 5-digit ids
+    explicit location_lists(int id_limit = 100000)
+        : left_count_(id_limit, 0),
+          right_count_(id_limit, 0),
+          block_size_(std::max(1, static_cast<int>(std::sqrt(id_limit)))),
+          d_(id_limit > 0 ? id_limit - 1 : 0, 0) // (D(x) for x in [0, id_limit - 1): D(id_limit - 1) is never needed)
+    {
+        blocks_.resize((d_.size() + block_size_ - 1) / block_size_);
+        for (size_t b = 0; b < blocks_.size(); ++b) {
+            blocks_[b].size = std::min<int>(block_size_, d_.size() - b * block_size_);
+            blocks_[b].histogram.assign(1, blocks_[b].size);
+        }
+    }
+
+    // (a left id adds to D(x) for x >= id; a right id subtracts from it)
+    void insert_left(int id)  { change(id, +1, left_count_, right_count_, +1); }
+    void remove_left(int id)  { change(id, -1, left_count_, right_count_, -1); }
+    void insert_right(int id) { change(id, +1, right_count_, left_count_, -1); }
+    void remove_right(int id) { change(id, -1, right_count_, left_count_, +1); }
+
+    int_least64_t total_distance() const { return total_distance_; }
+    int_least64_t similarity_score() const { return similarity_score_; }
+
+private:
+    struct block {
+        int size = 0;
+        int pending = 0;                            // (added to every D(x) in the block)
+        int negative = 0;                           // (the number of x with D(x) < 0)
+        int lowest = 0;                             // (the stored value counted in histogram[0])
+        std::vector<int> histogram;                 // (stored value - lowest -> how many x have it)
+    };
+
+    std::vector<int> left_count_;
+    std::vector<int> right_count_;
+    int block_size_;
+    std::vector<int> d_;        // (D(x) minus its block's pending amount)
+    std::vector<block> blocks_;
+    int_least64_t total_distance_ = 0;
+    int_least64_t similarity_score_ = 0;
+
+    // add count_delta (+1 or -1) to count[id] and delta (+1 or -1) to D(x)
+    // for every x >= id; other is the count for the other list
+    void change(int id, int count_delta, std::vector<int> & count, const std::vector<int> & other, int delta)
+    {
+        assert(0 <= id && id < static_cast<int>(count.size()));    // (out of the id range given)
+        assert(count[id] + count_delta >= 0);                       // (removing an id that isn't there)
+        count[id] += count_delta;
+        similarity_score_ += static_cast<int_least64_t>(id) * other[id] * count_delta;
+
+        const int end = d_.size();
+        int x = id;
+        // the partial block at the start, one x at a time...
+        for (; x < end && x % block_size_ != 0; ++x)
+            add_one(x, delta);
+        // ...then whole blocks at once
+        if (x < end)
+            for (int b = x / block_size_; b < static_cast<int>(blocks_.size()); ++b)
+                add_to_block(blocks_[b], delta);
+    }
+
+    void add_one(int x, int delta)
+    {
+        block & blk = blocks_[x / block_size_];
+        const int before = d_[x] + blk.pending;
+        const int after = before + delta;
+        total_distance_ += std::abs(after) - std::abs(before);
+        blk.negative += (after < 0) - (before < 0);
+        --blk.histogram[d_[x] - blk.lowest];
+        d_[x] += delta;
+        ++histogram_entry(blk, d_[x]);
+    }
+
+    // return the histogram count for the given stored value, widening the
+    // histogram to take it if need be (a stored value only ever moves one
+    // step at a time, and the histogram at least doubles when it widens, so
+    // this is rarely more than an index)
+    static int & histogram_entry(block & blk, int stored)
+    {
+        const int size = blk.histogram.size();
+        if (stored < blk.lowest) {
+            const int grow = std::max(blk.lowest - stored, size);
+            blk.histogram.insert(blk.histogram.begin(), grow, 0);
+            blk.lowest -= grow;
+        }
+        else if (stored - blk.lowest >= size)
+            blk.histogram.resize(std::max(stored - blk.lowest + 1, 2 * size), 0);
+        return blk.histogram[stored - blk.lowest];
+    }
+
+    void add_to_block(block & blk, int delta)
+    {
+        auto how_many = [&](int stored) {
+            const unsigned i = stored - blk.lowest;
+            return i < blk.histogram.size() ? blk.histogram[i] : 0;
+        };
+        if (delta > 0) {
+            // every D(x) >= 0 gets further from 0 and every D(x) < 0 nearer;
+            // those that were -1 become 0
+            total_distance_ += blk.size - 2 * blk.negative;
+            blk.negative -= how_many(-1 - blk.pending);
+        }
+        else {
+            // every D(x) > 0 gets nearer to 0 and every D(x) <= 0 further; those
+            // that were 0 become -1
+            const int zero = how_many(-blk.pending);
+            total_distance_ += (blk.negative + zero) - (blk.size - blk.negative - zero);
+            blk.negative += zero;
+        }
+        blk.pending += delta;
+    }
+};
+#endif
+
+
+#ifdef USE_EXTERNAL_SORT
+// For lists too big to fit in memory: each list is sorted in runs of at most
+// run_size ids, each run spilled to a temporary file, and the runs then
+// merged back a buffer at a time. Both merged lists are walked together in
+// id order, which gives both answers in one pass: with D(x) = (left ids <= x)
+// - (right ids <= x), the total distance is the sum of |D(x)| over every x
+// (see location_lists above), and D only changes at ids that appear, so it's
+// the sum of |D| times the gap to the next id; and the similarity score is
+// the sum of id * left count * right count.
+
+// a temporary file holding one sorted run of ids, read back a buffer at a time
+class run_reader {
+public:
+    run_reader(const std::filesystem::path & path, size_t buffer_size)
+        : file_(std::fopen(path.string().c_str(), "rb"), &std::fclose),
+          buffer_(buffer_size)
+    {
+        refill();
+    }
+
+    bool is_open() const { return file_ != nullptr; }
+    bool empty() const { return next_ == end_; }
+    int front() const { return buffer_[next_]; }
+    void pop()
+    {
+        if (++next_ == end_)
+            refill();
+    }
+
+private:
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file_;
+    std::vector<int> buffer_;
+    size_t next_ = 0;
+    size_t end_ = 0;
+
+    void refill()
+    {
+        next_ = 0;
+        end_ = file_ ? std::fread(buffer_.data(), sizeof(int), buffer_.size(), file_.get()) : 0;
+    }
+};
+
+// the ids in some sorted runs merged into one sorted sequence
+class run_merger {
+public:
+    run_merger() = default;
+
+    // open the given run files, keeping them open until the merger is destroyed
+    run_merger(const std::vector<std::filesystem::path> & paths, size_t buffer_size)
+    {
+        readers_.reserve(paths.size());
+        for (const std::filesystem::path & path : paths) {
+            readers_.emplace_back(path, buffer_size);
+            is_open_ = is_open_ && readers_.back().is_open();
+            if (!readers_.back().empty())
+                heads_.push({readers_.back().front(), static_cast<unsigned>(readers_.size() - 1)});
+        }
+    }
+
+    bool is_open() const { return is_open_; }
+    bool empty() const { return heads_.empty(); }
+    int front() const { return heads_.top().first; }
+    void pop()
+    {
+        const unsigned run = heads_.top().second;
+        heads_.pop();
+        readers_[run].pop();
+        if (!readers_[run].empty())
+            heads_.push({readers_[run].front(), run});
+    }
+
+private:
+    std::vector<run_reader> readers_;
+    // (the smallest unmerged id in each run, smallest first)
+    std::priority_queue<std::pair<int, unsigned>, std::vector<std::pair<int, unsigned>>, std::greater<>> heads_;
+    bool is_open_ = true;   // (false if any of the files couldn't be opened)
+};
+
+// one list of ids sorted with at most run_size of them in memory at a time:
+// push() every id, call finish(), then front() and pop() return them in order
+//
+// Each run is written to its own named temporary file, which is closed as
+// soon as it's written, so however many runs there are, the only files open
+// are the (at most max_open_runs) runs being merged.
+class external_sorter {
+public:
+    explicit external_sorter(size_t run_size)
+        : run_size_(run_size)
+    {
+        run_.reserve(run_size);
+    }
+
+    ~external_sorter()
+    {
+        merger_ = run_merger(); // (close the files before removing them)
+        for (const std::filesystem::path & path : runs_) {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+    }
+
+    external_sorter(const external_sorter &) = delete;
+    external_sorter & operator=(const external_sorter &) = delete;
+
+    // return false if a run couldn't be spilled
+    bool push(int id)
+    {
+        run_.push_back(id);
+        return run_.size() < run_size_ || spill();
+    }
+
+    // return false if a run couldn't be spilled or merged
+    bool finish()
+    {
+        if (!run_.empty() && !spill())
+            return false;
+
+        // (no more than max_open_runs files are open for merging at once, so
+        // if there are more runs than that, merge them into longer runs first,
+        // using run_ as the output buffer)
+        while (runs_.size() > max_open_runs)
+            if (!merge_first_runs(max_open_runs))
+                return false;
+        run_ = {}; // (the memory goes to the merge buffers now)
+
+        merger_ = run_merger(runs_, buffer_size(runs_.size()));
+        return merger_.is_open();
+    }
+
+    bool empty() const { return merger_.empty(); }
+    int front() const { return merger_.front(); }
+    void pop() { merger_.pop(); }
+
+private:
+    static constexpr size_t max_open_runs = 64;
+
+    size_t run_size_;
+    std::vector<int> run_;
+    std::vector<std::filesystem::path> runs_; // (the files of the runs not yet merged into others)
+    run_merger merger_;
+
+    // return the size of buffer for each of the given number of runs being
+    // merged, so that together they hold about run_size ids
+    size_t buffer_size(size_t runs) const
+    {
+        return std::max<size_t>(1024, run_size_ / std::max<size_t>(1, runs));
+    }
+
+    // create a new temporary file for a run and add it to runs_ (so it's
+    // removed however things turn out); return the file opened for writing,
+    // or nullptr if there isn't one
+    std::FILE * new_run()
+    {
+        static const unsigned tag = std::random_device{}();    // (so that two processes don't try the same names)
+        static std::atomic<unsigned> next_name = 0;
+        std::error_code error;
+        const std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+        if (error)
+            return nullptr;
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            std::filesystem::path path = directory / ("aoc-2024-01-" + std::to_string(tag) + "-" + std::to_string(next_name++) + ".run");
+            // ("x": fail rather than open a file that's already there)
+            if (std::FILE * file = std::fopen(path.string().c_str(), "wbx")) {
+                runs_.push_back(std::move(path));
+                return file;
+            }
+        }
+        return nullptr;
+    }
+
+    // write run_ to the given file, empty run_ and close the file; return
+    // false if any of that failed
+    bool write_run(std::FILE * file)
+    {
+        const bool written = std::fwrite(run_.data(), sizeof(int), run_.size(), file) == run_.size();
+        run_.clear();
+        return (std::fclose(file) == 0) && written;
+    }
+
+    bool spill()
+    {
+        std::ranges::sort(run_);
+        std::FILE * file = new_run();
+        return file && write_run(file);
+    }
+
+    // merge the first count runs into one new run at the end of runs_, with
+    // run_ (which must be empty) as the output buffer; return false if it
+    // couldn't be written
+    bool merge_first_runs(size_t count)
+    {
+        const std::vector<std::filesystem::path> group(runs_.begin(), runs_.begin() + count);
+        {
+            run_merger merger(group, buffer_size(count));
+            std::FILE * file = merger.is_open() ? new_run() : nullptr;
+            if (!file)
+                return false;
+            for (; !merger.empty(); merger.pop()) {
+                run_.push_back(merger.front());
+                if (run_.size() == run_size_) {
+                    if (std::fwrite(run_.data(), sizeof(int), run_.size(), file) != run_.size()) {
+                        run_.clear();
+                        std::fclose(file);
+                        return false;
+                    }
+                    run_.clear();
+                }
+            }
+            if (!write_run(file))
+                return false;
+        }
+        runs_.erase(runs_.begin(), runs_.begin() + count);
+        for (const std::filesystem::path & path : group) {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+        return true;
+    }
+};
+
+// solve the puzzle with at most about 3 * run_size ids in memory at once;
+// return false if the input isn't as expected or a temporary file couldn't be written
+bool solve_external(std::string_view text, size_t run_size, int_least64_t & total_distance, int_least64_t & similarity_score)
+{
+    total_distance = similarity_score = 0;
+
+    external_sorter left(run_size);
+    external_sorter right(run_size);
+    for (int left_id, right_id; next_number(text, left_id); ) {
+        if (!next_number(text, right_id))
+            return false;
+        if (!left.push(left_id) || !right.push(right_id))
+            return false;
+    }
+    if (!left.finish() || !right.finish())
+        return false;
+
+    int_least64_t d = 0; // (D(x) for x from the previous id up to the next)
+    int previous_id = 0;
+    for (bool first = true; !left.empty() || !right.empty(); first = false) {
+        const int id = left.empty() ? right.front()
+                     : right.empty() ? left.front()
+                     : std::min(left.front(), right.front());
+        if (!first)
+            total_distance += std::abs(d) * (static_cast<int_least64_t>(id) - previous_id);
+        int_least64_t left_count = 0, right_count = 0;
+        for (; !left.empty() && left.front() == id; left.pop())
+            ++left_count;
+        for (; !right.empty() && right.front() == id; right.pop())
+            ++right_count;
+        similarity_score += id * left_count * right_count;
+        d += left_count - right_count;
+        previous_id = id;
+    }
+    return true;
 }
+#endif
 
 
+// my puzzle answers
+constexpr int_least64_t part1_answer = 1258579;
+constexpr int_least64_t part2_answer = 23981443;
+
+
+
+#ifndef ALL_DAYS
 int main()
 {
-    std::vector<int> left_list, right_list;
-    std::ifstream input("input01.txt");
-    if (!input.is_open())
+    const mapped_file input_file("input01.txt");
+#if defined(USE_EXTERNAL_SORT)
+    if (!input_file.is_open())
         return EXIT_FAILURE;
-    for (int left, right; input >> left >> right;) {
-        left_list.push_back(left);
-        right_list.push_back(right);
-    }
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+    int_least64_t total_distance = 0;
+    int_least64_t similarity_score = 0;
+
+    // (a million ids per list in memory, 8 MB in all; my input is one small run)
+    constexpr size_t run_size = 1 << 20;
+    bool input_ok = true;
+    const auto timing = benchmark("01", [&] {
+        input_ok = solve_external(input_file.text(), run_size, total_distance, similarity_score);
+    });
+    if (!input_ok)
+        return EXIT_FAILURE;
+#elif defined(USE_INCREMENTAL)
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     int_least64_t total_distance = 0;
     int_least64_t similarity_score = 0;
-    const int repetitions = 1000;
-    for (int i = 0; i < repetitions; ++i)
-        solve(left_list, right_list, total_distance, similarity_score);
 
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    // feed the ids in one pair at a time, as if they were arriving live; the
+    // time is for the whole feed, with both answers up to date after every pair
+    const auto timing = benchmark("01", [&] {
+        location_lists lists;
+        for (size_t i = 0; i < input.left_list.size(); ++i) {
+            lists.insert_left(input.left_list[i]);
+            lists.insert_right(input.right_list[i]);
+        }
+        total_distance = lists.total_distance();
+        similarity_score = lists.similarity_score();
+    });
+#elif defined(USE_STREAMING)
+    if (!input_file.is_open())
+        return EXIT_FAILURE;
+
+    int_least64_t total_distance = 0;
+    int_least64_t similarity_score = 0;
+
+    // (the time includes reading the input, which overlaps with building the lists)
+    bool input_ok = true;
+    const auto timing = benchmark("01", [&] { input_ok = solve_streaming(input_file.text(), total_distance, similarity_score); });
+    if (!input_ok)
+        return EXIT_FAILURE;
+#else
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
+
+    int_least64_t total_distance = 0;
+    int_least64_t similarity_score = 0;
+
+    const auto timing = benchmark("01", [&] { solve(input, total_distance, similarity_score); });
+#endif
 
     std::cout << total_distance << '\n';
-    assert(total_distance == 1258579);
+    assert(total_distance == part1_answer);
     std::cout << similarity_score << '\n';
-    assert(similarity_score == 23981443);
-    std::cout << "(" << ms.count() / repetitions << " ms)\n";
+    assert(similarity_score == part2_answer);
+    std::cout << timing << '\n';
 }
+#endif
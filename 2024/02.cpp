@@ -2,106 +2,406 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
+#include <span>
+#include <memory_resource>
+#include <cstdint>
 
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
+#include "tokenizer.h"
+#ifdef USE_STREAMING
+#include "record_stream.h"
+#endif
+#ifdef USE_THREADS
+#include "thread_pool.h"
+#endif
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+struct input_data {
+    // the levels of every report one after another, and where each report
+    // ends: report r is levels[report_ends[r - 1]] to levels[report_ends[r] - 1]
+    std::vector<int> levels;
+    std::vector<uint32_t> report_ends;
+
+    size_t size() const { return report_ends.size(); }
+    uint32_t report_start(size_t r) const { return r == 0 ? 0 : report_ends[r - 1]; }
+    std::span<const int> report(size_t r) const
+    {
+        return std::span<const int>(levels).subspan(report_start(r), report_ends[r] - report_start(r));
+    }
+};
 
-void solve(const std::vector<std::vector<int>> & reports, int & total_safe_reports, int & total_safe_reports_with_dampener)
+// return true iff the levels in the given report are all increasing or all
+// decreasing by 1 to 3 at each step
+bool safe_report(std::span<const int> report)
 {
-    total_safe_reports = total_safe_reports_with_dampener = 0;
+    // (assume all reports have at least two levels)
+    const bool increasing = report[1] > report[0];
+    for (unsigned i = 1; i < report.size(); ++i) {
+        int difference = increasing ? report[i] - report[i-1] : report[i-1] - report[i];
+        if (difference < 1 || difference > 3)
+            return false;
+    }
+    return true;
+}
 
-    // part 1
+#if !defined(USE_K_REMOVALS) && !defined(USE_COPY_ERASE) && !defined(USE_AVOID_INDEX)
+// return true iff removing at most one level from the given report leaves
+// every step going in the given direction by 1 to 3
+//
+// Everything up to the first bad step is fine, and one of the two levels
+// either side of that step has to go, so those two are the only candidates:
+// check the rest of the report once without each of them. That's O(n)
+// rather than trying the report without every level in turn, which is O(n^2).
+bool safe_in_direction_with_dampener(std::span<const int> report, bool increasing)
+{
+    auto good_step = [increasing](int from, int to) {
+        const int difference = increasing ? to - from : from - to;
+        return 1 <= difference && difference <= 3;
+    };
 
-    auto safe_report = [](const std::vector<int> & report) -> bool {
-        // (assume all reports have at least two levels)
-        const bool increasing = report[1] > report[0];
-        for (unsigned i = 1; i < report.size(); ++i) {
-            int difference = increasing ? report[i] - report[i-1] : report[i-1] - report[i];
-            if (difference < 1 || difference > 3)
+    const unsigned n = report.size();
+    unsigned bad = 1;
+    while (bad < n && good_step(report[bad - 1], report[bad]))
+        ++bad;
+    if (bad == n)
+        return true;
+
+    // return true iff the steps from the level before skip onwards are all
+    // good with the level at skip removed
+    auto safe_without = [&](unsigned skip) {
+        // (the level before skip, if there is one, must step to the one after it)
+        if (skip > 0 && skip + 1 < n && !good_step(report[skip - 1], report[skip + 1]))
+            return false;
+        for (unsigned i = skip + 2; i < n; ++i)
+            if (!good_step(report[i - 1], report[i]))
                 return false;
-        }
         return true;
     };
-    for (const auto & report : reports)
-        if (safe_report(report))
-            ++total_safe_reports;
+    return safe_without(bad - 1) || safe_without(bad);
+}
+#endif
 
+// return true iff removing at most max_removals levels from the given report
+// makes it safe
+//
+// For each level i, removed[i] is the fewest levels that must be removed from
+// those before it for the report to step safely up to level i, keeping it.
+// That's the least of removed[j] + (i - j - 1) over the levels j that step
+// safely to i, where only the max_removals + 1 levels before i can be in
+// range. So it's O(n * max_removals) for each direction, where trying every
+// way to remove k levels would be O(n^k). (removed is the caller's, so one
+// vector serves every report.)
+bool safe_report_with_removals(std::span<const int> report, unsigned max_removals, std::pmr::vector<unsigned> & removed)
+{
+    const unsigned n = report.size();
+    if (n <= max_removals + 1)
+        return true; // (remove all but one level)
+    removed.resize(n);
+    for (const bool increasing : {true, false}) {
+        for (unsigned i = 0; i < n; ++i) {
+            removed[i] = i; // (remove every level before this one)
+            for (unsigned j = i > max_removals + 1 ? i - max_removals - 1 : 0; j < i; ++j) {
+                const int difference = increasing ? report[i] - report[j] : report[j] - report[i];
+                if (1 <= difference && difference <= 3)
+                    removed[i] = std::min(removed[i], removed[j] + (i - j - 1));
+            }
+            // (and remove every level after this one)
+            if (removed[i] + (n - 1 - i) <= max_removals)
+                return true;
+        }
+    }
+    return false;
+}
 
-    // part 2
+#ifdef USE_K_REMOVALS
+// the most levels the dampener may remove; the puzzle's removes one, but
+// building with -DDAMPENER_REMOVALS=k lets it remove up to k
+#ifndef DAMPENER_REMOVALS
+#define DAMPENER_REMOVALS 1
+#endif
+constexpr unsigned dampener_removals = DAMPENER_REMOVALS;
+#endif
 
-#ifdef USE_COPY_ERASE
-    for (const auto & report : reports)
-        if (safe_report(report))
-            ++total_safe_reports_with_dampener;
-        else
-            for (unsigned i = 0; i < report.size(); ++i) {
-                auto dampened_report{report};
-                dampened_report.erase(dampened_report.begin() + i);
-                if (safe_report(dampened_report)) {
-                    ++total_safe_reports_with_dampener;
-                    break;
-                }
+// return true iff removing one level (dampener_removals with USE_K_REMOVALS)
+// from the given report makes it safe (removed is scratch space for
+// USE_K_REMOVALS, kept from one report to the next)
+bool safe_report_with_dampener(std::span<const int> report, [[maybe_unused]] std::pmr::vector<unsigned> & removed)
+{
+#if defined(USE_K_REMOVALS)
+    return safe_report_with_removals(report, dampener_removals, removed);
+#elif defined(USE_COPY_ERASE)
+    for (unsigned i = 0; i < report.size(); ++i) {
+        std::vector<int> dampened_report(report.begin(), report.end());
+        dampened_report.erase(dampened_report.begin() + i);
+        if (safe_report(dampened_report))
+            return true;
+    }
+    return false;
+#elif defined(USE_AVOID_INDEX)
+    for (unsigned avoid_index = 0; avoid_index < report.size(); ++avoid_index) {
+        auto dampened_report = [&](unsigned index) {
+            return report[(index < avoid_index) ? index : index + 1];
+        };
+        auto safe_dampened_report = [&](std::span<const int> report) {
+            const bool increasing = dampened_report(1) > dampened_report(0);
+            for (unsigned i = 1; i < report.size() - 1; ++i) {
+                const int difference = increasing
+                    ? dampened_report(i) - dampened_report(i-1)
+                    : dampened_report(i-1) - dampened_report(i);
+                if (difference < 1 || difference > 3)
+                    return false;
             }
+            return true;
+        };
+        if (safe_dampened_report(report))
+            return true;
+    }
+    return false;
 #else
-    auto safe_report_with_dampener = [](const std::vector<int> & report) -> bool {
-        for (unsigned avoid_index = 0; avoid_index < report.size(); ++avoid_index) {
-            auto dampened_report = [&](unsigned index) {
-                return report[(index < avoid_index) ? index : index + 1];
-            };
-            auto safe_dampened_report = [&](const std::vector<int> & report) {
-                const bool increasing = dampened_report(1) > dampened_report(0);
-                for (unsigned i = 1; i < report.size() - 1; ++i) {
-                    const int difference = increasing
-                        ? dampened_report(i) - dampened_report(i-1)
-                        : dampened_report(i-1) - dampened_report(i);
-                    if (difference < 1 || difference > 3)
-                        return false;
-                }
-                return true;
-            };
-            if (safe_dampened_report(report))
-                return true;
+    return safe_in_direction_with_dampener(report, true)
+        || safe_in_direction_with_dampener(report, false);
+#endif
+}
+
+
+// set bit i of increases iff levels[i + 1] - levels[i] is 1 to 3, and bit i of
+// decreases iff it's -3 to -1; 8 (AVX2) or 4 (SSE2) steps at a time, without
+// branching on the levels (the steps from the last level of one report to the
+// first of the next are classified too, but never looked at)
+void classify_steps(std::span<const int> levels, std::pmr::vector<uint64_t> & increases, std::pmr::vector<uint64_t> & decreases)
+{
+    const size_t steps = levels.empty() ? 0 : levels.size() - 1;
+    increases.assign((steps + 63) / 64, 0);
+    decreases.assign((steps + 63) / 64, 0);
+
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i four = _mm256_set1_epi32(4);
+    const __m256i minus_four = _mm256_set1_epi32(-4);
+    for (; i + 8 <= steps; i += 8) {
+        const __m256i difference = _mm256_sub_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels.data() + i + 1)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels.data() + i)));
+        const __m256i up = _mm256_and_si256(_mm256_cmpgt_epi32(difference, zero), _mm256_cmpgt_epi32(four, difference));
+        const __m256i down = _mm256_and_si256(_mm256_cmpgt_epi32(zero, difference), _mm256_cmpgt_epi32(difference, minus_four));
+        // (i is a multiple of 8, so all 8 bits land in the same word)
+        increases[i / 64] |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(up))) << (i % 64);
+        decreases[i / 64] |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(down))) << (i % 64);
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i minus_four = _mm_set1_epi32(-4);
+    for (; i + 4 <= steps; i += 4) {
+        const __m128i difference = _mm_sub_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels.data() + i + 1)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels.data() + i)));
+        const __m128i up = _mm_and_si128(_mm_cmpgt_epi32(difference, zero), _mm_cmpgt_epi32(four, difference));
+        const __m128i down = _mm_and_si128(_mm_cmpgt_epi32(zero, difference), _mm_cmpgt_epi32(difference, minus_four));
+        increases[i / 64] |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(up))) << (i % 64);
+        decreases[i / 64] |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(down))) << (i % 64);
+    }
+#endif
+    for (; i < steps; ++i) {
+        const int difference = levels[i + 1] - levels[i];
+        increases[i / 64] |= uint64_t(1 <= difference && difference <= 3) << (i % 64);
+        decreases[i / 64] |= uint64_t(-3 <= difference && difference <= -1) << (i % 64);
+    }
+}
+
+// return true iff bits [first, last) of the given bits are all set
+bool all_bits_set(const std::pmr::vector<uint64_t> & bits, size_t first, size_t last)
+{
+    while (first < last) {
+        const size_t offset = first % 64;
+        const size_t count = std::min<size_t>(64 - offset, last - first);
+        const uint64_t mask = (count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1) << offset;
+        if ((bits[first / 64] & mask) != mask)
+            return false;
+        first += count;
+    }
+    return true;
+}
+
+
+#ifdef USE_THREADS
+// add the number of safe reports in reports [first, last) to safe, and the
+// number that are safe with the dampener to safe_with_dampener
+void count_safe_reports(const input_data & input, size_t first, size_t last, int & safe, int & safe_with_dampener)
+{
+    if (first == last)
+        return;
+    scratch_arena arena;
+    const size_t base = input.report_start(first);
+    std::pmr::vector<uint64_t> increases(&arena);
+    std::pmr::vector<uint64_t> decreases(&arena);
+    std::pmr::vector<unsigned> removed(&arena);
+    classify_steps(std::span<const int>(input.levels).subspan(base, input.report_ends[last - 1] - base), increases, decreases);
+    for (size_t r = first; r < last; ++r) {
+        const size_t first_step = input.report_start(r) - base;
+        const size_t last_step = input.report_ends[r] - 1 - base;
+        if (all_bits_set(increases, first_step, last_step) || all_bits_set(decreases, first_step, last_step)) {
+            ++safe;
+            ++safe_with_dampener;
         }
-        return false;
-    };
-    for (const auto & report : reports)
-        if (safe_report(report) || safe_report_with_dampener(report))
-            ++total_safe_reports_with_dampener;
+        else if (safe_report_with_dampener(input.report(r), removed))
+            ++safe_with_dampener;
+    }
+}
+#endif
+
+
+void solve(const input_data & input, int & total_safe_reports, int & total_safe_reports_with_dampener)
+{
+    total_safe_reports = total_safe_reports_with_dampener = 0;
+
+#ifdef USE_THREADS
+    // each thread counts both parts for its share of the reports, in chunks of
+    // at least 4096 reports, and the counts are added up at the end
+    thread_pool & pool = shared_thread_pool();
+    const unsigned chunks = static_cast<unsigned>(std::min<size_t>(pool.size() * 4, input.size() / 4096));
+    if (chunks > 1) {
+        perf_part("parts 1 and 2");
+        struct alignas(64) counts { // (each on its own cache line, so the threads don't share one)
+            int safe = 0;
+            int safe_with_dampener = 0;
+        };
+        std::vector<counts> chunk_counts(chunks);
+        pool.for_each(chunks, [&](unsigned chunk) {
+            count_safe_reports(input, input.size() * chunk / chunks, input.size() * (chunk + 1) / chunks,
+                chunk_counts[chunk].safe, chunk_counts[chunk].safe_with_dampener);
+        });
+        for (const counts & c : chunk_counts) {
+            total_safe_reports += c.safe;
+            total_safe_reports_with_dampener += c.safe_with_dampener;
+        }
+        return;
+    }
 #endif
 
+    scratch_arena arena;
+    std::pmr::vector<char> safe(input.size(), 0, &arena);
+
+    // part 1
+    perf_part("part 1");
+
+    // a report is safe if all its steps are good increases or all are good decreases
+    std::pmr::vector<uint64_t> increases(&arena);
+    std::pmr::vector<uint64_t> decreases(&arena);
+    classify_steps(input.levels, increases, decreases);
+    for (size_t r = 0; r < input.size(); ++r) {
+        // (the steps in report r are those from each of its levels but the last)
+        const size_t first = input.report_start(r);
+        const size_t last = input.report_ends[r] - 1;
+        safe[r] = all_bits_set(increases, first, last) | all_bits_set(decreases, first, last);
+        total_safe_reports += safe[r];
+    }
+
+
+    // part 2
+    perf_part("part 2");
+
+    std::pmr::vector<unsigned> removed(&arena);
+    for (size_t r = 0; r < input.size(); ++r)
+        if (safe[r] || safe_report_with_dampener(input.report(r), removed))
+            ++total_safe_reports_with_dampener;
+}
+
+
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
+{
+    // (each line is a report, so the tokenizer's line ends are the report ends)
+    tokenize_numbers(text, input.levels, &input.report_ends);
+    for (size_t r = 0; r < input.size(); ++r)
+        if (input.report(r).size() < 2)
+            return false; // (assume all reports have at least two levels)
+    return true;
+}
+
+
+#ifdef USE_STREAMING
+// solve the puzzle while the input text is still being read: each report is
+// checked as soon as the reader thread has parsed it; return false if the
+// input isn't as expected
+bool solve_streaming(std::string_view text, int & total_safe_reports, int & total_safe_reports_with_dampener)
+{
+    total_safe_reports = total_safe_reports_with_dampener = 0;
+    scratch_arena arena;
+    std::pmr::vector<unsigned> removed(&arena);
+    return stream_records<std::vector<int>>(text,
+        [](std::string_view line, std::vector<int> & report) {
+            for (int level; next_number(line, level); )
+                report.push_back(level);
+            return report.size() >= 2; // (assume all reports have at least two levels)
+        },
+        [&](const std::vector<int> & report) {
+            if (safe_report(report)) {
+                ++total_safe_reports;
+                ++total_safe_reports_with_dampener;
+            }
+            else if (safe_report_with_dampener(report, removed))
+                ++total_safe_reports_with_dampener;
+        });
 }
+#endif
+
+
+// my puzzle answers
+constexpr int part1_answer = 502;
+constexpr int part2_answer = 544;
 
 
+
+#ifndef ALL_DAYS
 int main()
 {
-    std::vector<std::vector<int>> reports;
-    std::ifstream input("input02.txt");
-    if (!input.is_open())
+    const mapped_file input_file("input02.txt");
+#ifdef USE_STREAMING
+    if (!input_file.is_open())
         return EXIT_FAILURE;
-    for (std::string report_text; std::getline(input, report_text); ) {
-        std::vector<int> report;
-        std::istringstream report_stream(report_text);
-        for (int level; report_stream >> level; )
-            report.push_back(level);
-        reports.push_back(report);
-    }
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+    int total_safe_reports = 0;
+    int total_safe_reports_with_dampener = 0;
+
+    // (the time includes reading the input, which overlaps with solving)
+    bool input_ok = true;
+    const auto timing = benchmark("02", [&] {
+        input_ok = solve_streaming(input_file.text(), total_safe_reports, total_safe_reports_with_dampener);
+    });
+    if (!input_ok)
+        return EXIT_FAILURE;
+#else
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     int total_safe_reports = 0;
     int total_safe_reports_with_dampener = 0;
-    const int repetitions = 1000;
-    for (int i = 0; i < repetitions; ++i)
-        solve(reports, total_safe_reports, total_safe_reports_with_dampener);
 
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("02", [&] { solve(input, total_safe_reports, total_safe_reports_with_dampener); });
+#endif
 
     std::cout << total_safe_reports << '\n';
-    assert(total_safe_reports == 502);
+    assert(total_safe_reports == part1_answer);
     std::cout << total_safe_reports_with_dampener << '\n';
-    assert(total_safe_reports_with_dampener == 544);
-    std::cout << ms.count() / repetitions << "ms\n";
+#ifdef USE_K_REMOVALS
+    // (my answer is for the puzzle's dampener; one that removes nothing
+    // should find just the part 1 reports)
+    assert(dampener_removals != 1 || total_safe_reports_with_dampener == part2_answer);
+    assert(dampener_removals != 0 || total_safe_reports_with_dampener == total_safe_reports);
+#else
+    assert(total_safe_reports_with_dampener == part2_answer);
+#endif
+    std::cout << timing << '\n';
 }
+#endif
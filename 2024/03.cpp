@@ -2,155 +2,141 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
-#include <regex>
 
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "token_matcher.h"
+#ifdef USE_THREADS
+#include "thread_pool.h"
+#endif
+
+// (the corrupted memory, read in place from the mapped input file, newlines and all)
+using input_data = std::string_view;
+
+
+// the instructions, in the order of the alternatives in the pattern
+enum { do_instruction, dont_instruction, mul_instruction };
+using instruction = token_matcher<"do()|don't()|mul(\\d{1,3},\\d{1,3})">;
+
+
+// the sums of the products of the mul instructions in one chunk of the memory
+struct chunk_sums {
+    unsigned all = 0;               // (part 1)
+    unsigned if_enabled = 0;        // (part 2, if mul was enabled at the start of the chunk...)
+    unsigned if_disabled = 0;       // (...or if it wasn't)
+    bool toggled = false;           // true iff the chunk has a do() or don't() in it...
+    bool enabled_at_end = false;    // ...and if so, whether the last was do()
+};
+
+// return the sums for the instructions that start in [first, last); they may
+// run on past last, up to c_end, so an instruction that straddles two chunks
+// is counted once, in the chunk it starts in
+//
+// No instruction has a 'd' or an 'm' in it after its first character, so
+// scanning from the start of a chunk finds the same instructions as scanning
+// from the start of the memory would (an instruction added to the pattern
+// that broke this would be counted twice where it straddled two chunks, so
+// it fails to compile instead). The part 2 sum is worked out both ways
+// at once, starting with mul enabled and starting with it disabled, so the
+// chunks can be scanned independently and combined afterwards.
+chunk_sums scan_chunk(const char * first, const char * last, const char * const c_end)
+{
+    static_assert(instruction::starts_only_at_start, "an instruction can't have a byte that starts an instruction after its first");
+    chunk_sums sums;
+    unsigned enabled_if_enabled = 1, enabled_if_disabled = 0;
+    instruction::for_each_token(first, last, c_end, [&](const instruction::match & token) {
+        switch (token.alternative) {
+        case do_instruction:
+            enabled_if_enabled = enabled_if_disabled = 1;
+            break;
+        case dont_instruction:
+            enabled_if_enabled = enabled_if_disabled = 0;
+            break;
+        case mul_instruction: {
+            const unsigned product = token.numbers[0] * token.numbers[1];
+            sums.all += product;
+            sums.if_enabled += product * enabled_if_enabled;
+            sums.if_disabled += product * enabled_if_disabled;
+            break;
+        }
+        }
+    });
+    sums.toggled = enabled_if_enabled == enabled_if_disabled;
+    sums.enabled_at_end = enabled_if_disabled;
+    return sums;
+}
 
 
-void solve(const std::string & input_text, unsigned & part1_sum, unsigned & part2_sum)
+void solve(std::string_view input_text, unsigned & part1_sum, unsigned & part2_sum)
 {
     part1_sum = part2_sum = 0;
 
-#ifdef USE_REGEX
-    // part 1
-    std::regex mul_regex("mul\\(([0-9]{1,3}),([0-9]{1,3})\\)");
-    auto words_begin = std::sregex_iterator(input_text.begin(), input_text.end(), mul_regex);
-    auto words_end = std::sregex_iterator();
-    for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
-        std::smatch match = *i;
-        part1_sum += std::stoi(match[1]) * std::stoi(match[2]);
-    }
-
-    // part 2
-    std::regex do_dont_mul_regex("do\\(\\)|don't\\(\\)|mul\\(([0-9]{1,3}),([0-9]{1,3})\\)");
-    words_begin = std::sregex_iterator(input_text.begin(), input_text.end(), do_dont_mul_regex);
-    words_end = std::sregex_iterator();
-    bool enabled = true;
-    for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
-        std::smatch match = *i;
-        if (match[0] == "do()")
-            enabled = true;
-        else if (match[0] == "don't()")
-            enabled = false;
-        else if (enabled)
-            part2_sum += std::stoi(match[1]) * std::stoi(match[2]);
-    }
-#else
-    // part 1
-    auto match_here = [](const char * c, const char * const c_end, const char * str) -> bool {
-        for (; *str && c != c_end && *str == *c; ++str, ++c)
-            ;
-        return *str == '\0';
-    };
-
-    auto read_digits = [](const char * c, const char * const c_end, unsigned & value) -> int {
-        value = 0;
-        int digit_count = 0;
-        for (; c != c_end && std::isdigit(*c); ++c, ++digit_count)
-            value = value * 10 + *c - '0';
-        return digit_count;
-    };
-
-    auto read_mul = [&](const char * const c_begin, const char * const c_end, unsigned & value) -> int {
-        const char * c = c_begin;
-        if (!match_here(c, c_end, "mul("))
-            return 0;
-        c += 4;
-        if (c == c_end)
-            return 0;
-        unsigned a, b;
-        int digit_count = read_digits(c, c_end, a);
-        if (digit_count < 1 || digit_count > 3)
-            return 0;
-        c += digit_count;
-        if (c == c_end)
-            return 0;
-        if (*c != ',')
-            return 0;
-        ++c;
-        if (c == c_end)
-            return 0;
-        digit_count = read_digits(c, c_end, b);
-        if (digit_count < 1 || digit_count > 3)
-            return 0;
-        c += digit_count;
-        if (c == c_end)
-            return 0;
-        if (*c != ')')
-            return 0;
-        ++c;
-        value = a * b;
-        return c - c_begin;
-    };
-
-    const char * c = input_text.c_str();
-    const char * const c_end = c + input_text.size();
-    while (c != c_end) {
-        unsigned product = 0;
-        const unsigned mul_length = read_mul(c, c_end, product);
-        if (mul_length == 0)
-            ++c;
-        else {
-            c += mul_length;
-            part1_sum += product;
-        }
-    }
-
-    // part 2
-    c = input_text.c_str();
-    while (c != c_end) {
-        if (match_here(c, c_end, "don't()")) {
-            c += 7;
-            while (c != c_end && !match_here(c, c_end, "do()"))
-                ++c;
-            if (c == c_end)
-                break;
-            c += 4;
-            continue;
-        }
-        unsigned product = 0;
-        const unsigned mul_length = read_mul(c, c_end, product);
-        if (mul_length == 0)
-            ++c;
-        else {
-            c += mul_length;
-            part2_sum += product;
+    // parts 1 and 2 together, in one pass
+    perf_part("parts 1 and 2");
+    const char * const c_begin = input_text.data();
+    const char * const c_end = c_begin + input_text.size();
+#ifdef USE_THREADS
+    // scan chunks of at least 64KB on every thread, then follow the state
+    // from each chunk to the next to choose the part 2 sum for each
+    thread_pool & pool = shared_thread_pool();
+    const unsigned chunks = static_cast<unsigned>(std::min<size_t>(pool.size() * 4, input_text.size() / 65536));
+    if (chunks > 1) {
+        std::vector<chunk_sums> sums(chunks);
+        pool.for_each(chunks, [&](unsigned chunk) {
+            sums[chunk] = scan_chunk(c_begin + input_text.size() * chunk / chunks,
+                c_begin + input_text.size() * (chunk + 1) / chunks, c_end);
+        });
+        bool enabled = true;
+        for (const chunk_sums & chunk : sums) {
+            part1_sum += chunk.all;
+            part2_sum += enabled ? chunk.if_enabled : chunk.if_disabled;
+            if (chunk.toggled)
+                enabled = chunk.enabled_at_end;
         }
+        return;
     }
 #endif
+    const chunk_sums sums = scan_chunk(c_begin, c_end, c_end);
+    part1_sum = sums.all;
+    part2_sum = sums.if_enabled;
+}
+
+
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
+{
+    input = text;
+    return true;
 }
 
 
+// my puzzle answers
+constexpr unsigned part1_answer = 178794710;
+constexpr unsigned part2_answer = 76729637;
+
 
+
+#ifndef ALL_DAYS
 int main()
 {
-    std::string input_text;
-    std::ifstream input("input03.txt");
-    if (!input.is_open())
+    const mapped_file input_file("input03.txt");
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
         return EXIT_FAILURE;
-    for (std::string line; std::getline(input, line); )
-        input_text += line;
-
-
-    const auto start_time = std::chrono::high_resolution_clock::now();
 
     unsigned part1_sum = 0;
     unsigned part2_sum = 0;
 
-    const int repetitions = 1000;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input_text, part1_sum, part2_sum);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("03", [&] { solve(input, part1_sum, part2_sum); });
 
     std::cout << part1_sum << '\n';
-    assert(part1_sum == 178794710);
+    assert(part1_sum == part1_answer);
     std::cout << part2_sum << '\n';
-    assert(part2_sum == 76729637);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_sum == part2_answer);
+    std::cout << timing << '\n';
 }
+#endif
@@ -2,114 +2,491 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <regex>
+#include <memory_resource>
+#include <bit>
+#include <cstdint>
+#include <span>
 
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
+#ifdef USE_WORD_SEARCH
+#include "word_search.h"
+#endif
+#ifdef USE_THREADS
+#include "thread_pool.h"
+#endif
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-struct input_data {
-    std::string text;
-    unsigned rows = 0;
-    unsigned columns = 0;
+
+// (the letters are read in place from the mapped input file)
+using input_data = grid_view;
+
+
+const char x_forward[] = { "XMAS" };
+const char x_backward[] = { "SAMX" };
+const unsigned x_length = 4;
+
+// return true iff x_forward or x_backward exists at (r, c)..(r, c)+stride
+bool look(const grid_view & grid, unsigned r, unsigned c, unsigned stride)
+{
+    const char * start = grid.text.data() + r * grid.stride + c;
+    unsigned i = 0;
+    for (const char * s = start; i < x_length; ++i, s += stride)
+        if (*s != x_forward[i])
+            break;
+    if (i == x_length)
+        return true;
+    i = 0;
+    for (const char * s = start; i < x_length; ++i, s += stride)
+        if (*s != x_backward[i])
+            break;
+    return i == x_length;
+}
+
+// return true iff X-MAS cross exists in 3x3 grid at (r, c) (top left corner of grid)
+bool look2(const grid_view & grid, unsigned r, unsigned c)
+{
+    const char * start = grid.text.data() + r * grid.stride + c;
+    return (*(start + grid.stride + 1) == 'A')
+        && (   (*start == 'M' && *(start + 2 * grid.stride + 2) == 'S')
+            || (*start == 'S' && *(start + 2 * grid.stride + 2) == 'M'))
+        && (   (*(start + 2) == 'M' && *(start + 2 * grid.stride) == 'S')
+            || (*(start + 2) == 'S' && *(start + 2 * grid.stride) == 'M'));
+}
+
+
+#ifndef USE_CHAR_SCAN
+// the grid, or the rows [first_row, last_row) of it, as one bitboard for each
+// of the letters X, M, A and S: bit c % 64 of word c / 64 of row(letter, r) is
+// set iff the cell at (r, c) holds that letter, so a whole row of 64 cells can
+// be tested for a letter at once
+class letter_bitboards {
+public:
+    enum letter { X, M, A, S };
+
+    letter_bitboards(const grid_view & grid, std::pmr::memory_resource * resource)
+        : letter_bitboards(grid, 0, grid.rows, resource)
+    {}
+
+    letter_bitboards(const grid_view & grid, unsigned first_row, unsigned last_row, std::pmr::memory_resource * resource)
+        : first_row_(first_row), words_per_row_((grid.columns + 63) / 64),
+          bits_(size_t(4) * (last_row - first_row) * (words_per_row_ + 2), 0, resource)
+    {
+        for (unsigned r = first_row; r < last_row; ++r)
+            set_row(r, grid.text.data() + size_t(r) * grid.stride, grid.columns);
+    }
+
+    unsigned words_per_row() const { return words_per_row_; }
+
+    // (each row has a word of zeros either side, so row[-1] and
+    // row[words_per_row()] can be read)
+    const uint64_t * row(letter l, unsigned r) const
+    {
+        return bits_.data() + (size_t(r - first_row_) * 4 + l) * (words_per_row_ + 2) + 1;
+    }
+
+private:
+    unsigned first_row_;
+    unsigned words_per_row_;
+    std::pmr::vector<uint64_t> bits_;   // (the four letters' rows for each row of the grid are together)
+
+    uint64_t * row(letter l, unsigned r)
+    {
+        return bits_.data() + (size_t(r - first_row_) * 4 + l) * (words_per_row_ + 2) + 1;
+    }
+
+    // set the bits for the given row of cells, 64 cells at a time with AVX2
+    // or SSE2 compares, and one at a time for whatever is left
+    void set_row(unsigned r, const char * cells, unsigned columns)
+    {
+        unsigned c = 0;
+#if defined(__AVX2__)
+        for (; c + 64 <= columns; c += 64) {
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + c));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + c + 32));
+            auto set_word = [&](letter l) {
+                const __m256i letter_bytes = _mm256_set1_epi8("XMAS"[l]);
+                row(l, r)[c / 64] = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, letter_bytes))))
+                    | uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, letter_bytes)))) << 32;
+            };
+            set_word(X);
+            set_word(M);
+            set_word(A);
+            set_word(S);
+        }
+#elif defined(__SSE2__)
+        for (; c + 64 <= columns; c += 64) {
+            const __m128i q0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + c));
+            const __m128i q1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + c + 16));
+            const __m128i q2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + c + 32));
+            const __m128i q3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + c + 48));
+            auto set_word = [&](letter l) {
+                const __m128i letter_bytes = _mm_set1_epi8("XMAS"[l]);
+                row(l, r)[c / 64] = uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(q0, letter_bytes)))
+                    | uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(q1, letter_bytes))) << 16
+                    | uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(q2, letter_bytes))) << 32
+                    | uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(q3, letter_bytes))) << 48;
+            };
+            set_word(X);
+            set_word(M);
+            set_word(A);
+            set_word(S);
+        }
+#endif
+        for (; c < columns; ++c)
+            for (const letter l : {X, M, A, S})
+                row(l, r)[c / 64] |= uint64_t(cells[c] == "XMAS"[l]) << (c % 64);
+    }
 };
 
+// return word w of the given row of bits moved along so that bit i is the
+// bit for the cell k to the right of the cell it was for (k < 64)
+inline uint64_t right_of(const uint64_t * row, unsigned w, unsigned k)
+{
+    return k == 0 ? row[w] : (row[w] >> k) | (row[w + 1] << (64 - k));
+}
+
+// as right_of(), but the cell k to the left
+inline uint64_t left_of(const uint64_t * row, unsigned w, unsigned k)
+{
+    return k == 0 ? row[w] : (row[w] << k) | (row[int64_t(w) - 1] >> (64 - k));
+}
+
+// return the cells in word w of the bitboard rows that start XMAS or SAMX,
+// where cell(letter, step) is word w of the given letter's cells step cells
+// along from them (a cell can't start both, so they're counted together)
+template <typename Cell>
+uint64_t xmas_or_samx(Cell cell)
+{
+    using enum letter_bitboards::letter;
+    return (cell(X, 0) & cell(M, 1) & cell(A, 2) & cell(S, 3))
+         | (cell(S, 0) & cell(A, 1) & cell(M, 2) & cell(X, 3));
+}
+
+// return the number of XMASes that start in row r of the given grid rows,
+// going east and (if there's room below) south, south-east and south-west;
+// they're looked for 64 cells at a time
+unsigned xmases_from_row(const letter_bitboards & boards, unsigned r, unsigned rows)
+{
+    using letter = letter_bitboards::letter;
+    const unsigned words = boards.words_per_row();
+    const bool room_below = r + 3 < rows;
+    unsigned xmases = 0;
+    for (unsigned w = 0; w < words; ++w) {
+        xmases += std::popcount(xmas_or_samx([&](letter l, unsigned step) {
+            return right_of(boards.row(l, r), w, step);
+        }));
+        if (!room_below)
+            continue;
+        xmases += std::popcount(xmas_or_samx([&](letter l, unsigned step) {
+            return boards.row(l, r + step)[w];
+        }));
+        xmases += std::popcount(xmas_or_samx([&](letter l, unsigned step) {
+            return right_of(boards.row(l, r + step), w, step);
+        }));
+        xmases += std::popcount(xmas_or_samx([&](letter l, unsigned step) {
+            return left_of(boards.row(l, r + step), w, step);
+        }));
+    }
+    return xmases;
+}
+
+// return the number of X-MASes with their middle in row r (0 < r < rows - 1):
+// the middle of an X-MAS is an A with an M and an S at either end of both
+// diagonals through it
+unsigned x_mases_in_row(const letter_bitboards & boards, unsigned r)
+{
+    using enum letter_bitboards::letter;
+    const uint64_t * row_a = boards.row(A, r);
+    const uint64_t * above_m = boards.row(M, r - 1);
+    const uint64_t * above_s = boards.row(S, r - 1);
+    const uint64_t * below_m = boards.row(M, r + 1);
+    const uint64_t * below_s = boards.row(S, r + 1);
+    unsigned x_mases = 0;
+    for (unsigned w = 0; w < boards.words_per_row(); ++w) {
+        const uint64_t falling_diagonal     // (top left to bottom right)
+            = (left_of(above_m, w, 1) & right_of(below_s, w, 1))
+            | (left_of(above_s, w, 1) & right_of(below_m, w, 1));
+        const uint64_t rising_diagonal      // (bottom left to top right)
+            = (right_of(above_m, w, 1) & left_of(below_s, w, 1))
+            | (right_of(above_s, w, 1) & left_of(below_m, w, 1));
+        x_mases += std::popcount(row_a[w] & falling_diagonal & rising_diagonal);
+    }
+    return x_mases;
+}
+#endif
+
+
+#ifdef USE_THREADS
+// add the number of XMASes that start in rows [first, last) of the grid to
+// xmases, and the number of X-MASes with their middle in those rows to
+// x_mases; the bitboards for the band also have a halo of the row above it
+// and the three below it, so words that cross into the next band are found,
+// but only by the band they start in
+void count_band(const input_data & input, unsigned first, unsigned last, unsigned & xmases, unsigned & x_mases)
+{
+    scratch_arena arena;
+    const unsigned halo_first = first > 0 ? first - 1 : 0;
+    const unsigned halo_last = std::min(last + 3, input.rows);
+    const letter_bitboards boards(input, halo_first, halo_last, &arena);
+    for (unsigned r = first; r < last; ++r) {
+        xmases += xmases_from_row(boards, r, input.rows);
+        if (0 < r && r + 1 < input.rows)
+            x_mases += x_mases_in_row(boards, r);
+    }
+}
+#endif
+
+
 void solve(const input_data & input, unsigned & total_xmases, unsigned & total_x_mases)
 {
     total_xmases = total_x_mases = 0;
 
+#ifndef USE_CHAR_SCAN
+#ifdef USE_THREADS
+    // split the grid into bands of rows of at least 256K cells, count each
+    // band on its own thread and add up the counts
+    thread_pool & pool = shared_thread_pool();
+    const unsigned bands = static_cast<unsigned>(std::min<size_t>({pool.size() * 4,
+        (size_t(input.rows) * input.columns) >> 18, input.rows}));
+    if (bands > 1) {
+        perf_part("parts 1 and 2");
+        struct alignas(64) counts { // (each on its own cache line, so the threads don't share one)
+            unsigned xmases = 0;
+            unsigned x_mases = 0;
+        };
+        std::vector<counts> band_counts(bands);
+        pool.for_each(bands, [&](unsigned band) {
+            count_band(input, size_t(input.rows) * band / bands, size_t(input.rows) * (band + 1) / bands,
+                band_counts[band].xmases, band_counts[band].x_mases);
+        });
+        for (const counts & c : band_counts) {
+            total_xmases += c.xmases;
+            total_x_mases += c.x_mases;
+        }
+        return;
+    }
+#endif
+
+    perf_part("bitboards");
+    scratch_arena arena;
+    const letter_bitboards boards(input, &arena);
+
     // part 1
-    
-    const char x_forward[] = { "XMAS" };
-    const char x_backward[] = { "SAMX" };
-    const unsigned x_length = 4;
+    perf_part("part 1");
 
-    auto point = [&](unsigned r, unsigned c) {
-        return input.text.c_str() + r * input.columns + c;
-    };
+#ifdef USE_WORD_SEARCH
+    // (the general search, for any list of words, rather than the bitboards)
+    static const word_search search({"XMAS"});
+    total_xmases = search.count(input);
+#else
+    for (unsigned r = 0; r < input.rows; ++r)
+        total_xmases += xmases_from_row(boards, r, input.rows);
+#endif
 
-    // return true iff x_forward or x_backward exists at (r, c)..(r, c)+stride
-    auto look = [&](unsigned r, unsigned c, unsigned stride) {
-        const char * start = point(r, c);
-        unsigned i = 0;
-        for (const char * s = start; i < x_length; ++i, s += stride)
-            if (*s != x_forward[i])
-                break;
-        if (i == x_length)
-            return true;
-        i = 0;
-        for (const char * s = start; i < x_length; ++i, s += stride)
-            if (*s != x_backward[i])
-                break;
-        return i == x_length;
-    };
 
+    // part 2
+    perf_part("part 2");
+
+    for (unsigned r = 1; r + 1 < input.rows; ++r)
+        total_x_mases += x_mases_in_row(boards, r);
+#else
+    // part 1
+    perf_part("part 1");
+
+    // (the bounds are written as sums so they don't wrap in a grid smaller than a word)
     for (unsigned r = 0; r < input.rows; ++r)
         for (unsigned c = 0; c < input.columns; ++c) {
-            if (c <= input.columns - x_length) {
-                total_xmases += look(r, c, 1);                      // east
-                if (c <= input.columns - x_length)
-                    total_xmases += look(r, c, input.columns + 1);  // south-east
-            }
-            if (r <= input.rows - x_length) {
-                total_xmases += look(r, c, input.columns);          // south
+            if (c + x_length <= input.columns)
+                total_xmases += look(input, r, c, 1);                      // east
+            if (r + x_length <= input.rows) {
+                total_xmases += look(input, r, c, input.stride);           // south
+                if (c + x_length <= input.columns)
+                    total_xmases += look(input, r, c, input.stride + 1);   // south-east
                 if (c >= x_length - 1)
-                    total_xmases += look(r, c, input.columns - 1);  // south-west
+                    total_xmases += look(input, r, c, input.stride - 1);   // south-west
             }
         }
 
 
     // part 2
+    perf_part("part 2");
+
+    for (unsigned r = 0; r + 2 < input.rows; ++r)
+        for (unsigned c = 0; c + 2 < input.columns; ++c)
+            total_x_mases += look2(input, r, c);
+#endif
+}
+
+
+#ifdef USE_INCREMENTAL
+// a copy of the grid whose cells can be changed, with both answers kept up to
+// date as they are; a change re-examines only the windows that cover the
+// changed cells, the four-cell lines that XMAS might be in and the 3x3 boxes
+// that an X-MAS might be in, so its cost depends on how many cells changed,
+// not on the size of the grid
+class xmas_grid {
+public:
+    struct cell_update {
+        unsigned r;
+        unsigned c;
+        char letter;
+    };
+
+    explicit xmas_grid(const grid_view & grid)
+        : cells_(grid.text), grid_(grid)
+    {
+        grid_.text = cells_;
+        solve(grid_, total_xmases_, total_x_mases_);
+    }
+
+    // (grid_ is a view of cells_, so a copy or a move would still be looking
+    // at the original's cells)
+    xmas_grid(const xmas_grid &) = delete;
+    xmas_grid & operator=(const xmas_grid &) = delete;
+
+    unsigned total_xmases() const { return total_xmases_; }
+    unsigned total_x_mases() const { return total_x_mases_; }
+    const grid_view & grid() const { return grid_; }
+
+    // change the given cells (each window that covers any of them is counted
+    // out before the change and back in after it, once however many of the
+    // changed cells it covers); every cell must be in the grid, and a letter
+    // can't be a line end
+    void update(std::span<const cell_update> updates)
+    {
+        scratch_arena arena;
+        std::pmr::vector<uint64_t> lines(&arena);   // (((r * columns) + c) * 4 + direction of the first cell)
+        std::pmr::vector<uint64_t> boxes(&arena);   // ((r * columns) + c of the top left cell)
+        for (const cell_update & u : updates) {
+            assert(u.r < grid_.rows && u.c < grid_.columns);
+            assert(u.letter != '\n');
+            for (unsigned d = 0; d < 4; ++d)
+                for (int k = 0; k < int(x_length); ++k) {
+                    const int r = int(u.r) - k * directions[d].dr;
+                    const int c = int(u.c) - k * directions[d].dc;
+                    if (line_fits(r, c, d))
+                        lines.push_back((uint64_t(r) * grid_.columns + c) * 4 + d);
+                }
+            for (unsigned i = 0; i < 3; ++i)
+                for (unsigned j = 0; j < 3; ++j)
+                    if (u.r >= i && u.c >= j && u.r - i + 2 < grid_.rows && u.c - j + 2 < grid_.columns)
+                        boxes.push_back(uint64_t(u.r - i) * grid_.columns + (u.c - j));
+        }
+        for (auto * windows : {&lines, &boxes}) {
+            std::ranges::sort(*windows);
+            windows->erase(std::unique(windows->begin(), windows->end()), windows->end());
+        }
+
+        total_xmases_ -= count_lines(lines);
+        total_x_mases_ -= count_boxes(boxes);
+        for (const cell_update & u : updates)
+            cells_[size_t(u.r) * grid_.stride + u.c] = u.letter;
+        total_xmases_ += count_lines(lines);
+        total_x_mases_ += count_boxes(boxes);
+    }
 
-    // return true iff X-MAS cross exists in 3x3 grid at (r, c) (top left corner of grid)
-    auto look2 = [&](unsigned r, unsigned c) {
-        const char * start = point(r, c);
-        return (*(start + input.columns + 1) == 'A')
-            && (   (*start == 'M' && *(start + 2 * input.columns + 2) == 'S')
-                || (*start == 'S' && *(start + 2 * input.columns + 2) == 'M'))
-            && (   (*(start + 2) == 'M' && *(start + 2 * input.columns) == 'S')
-                || (*(start + 2) == 'S' && *(start + 2 * input.columns) == 'M'));
+private:
+    std::string cells_;
+    grid_view grid_;    // (a view of cells_)
+    unsigned total_xmases_ = 0;
+    unsigned total_x_mases_ = 0;
+
+    struct direction {
+        int dr;
+        int dc;
     };
+    static constexpr direction directions[4] = {{0, 1}, {1, 1}, {1, 0}, {1, -1}};  // (east, south-east, south, south-west)
+
+    // return true iff the x_length cells from (r, c) in direction d are all in the grid
+    bool line_fits(int r, int c, unsigned d) const
+    {
+        const int last_r = r + (int(x_length) - 1) * directions[d].dr;
+        const int last_c = c + (int(x_length) - 1) * directions[d].dc;
+        return r >= 0 && c >= 0 && last_r < int(grid_.rows)
+            && std::min(c, last_c) >= 0 && std::max(c, last_c) < int(grid_.columns);
+    }
+
+    unsigned count_lines(const std::pmr::vector<uint64_t> & lines) const
+    {
+        unsigned count = 0;
+        for (const uint64_t line : lines) {
+            const direction d = directions[line % 4];
+            const uint64_t cell = line / 4;
+            count += look(grid_, cell / grid_.columns, cell % grid_.columns, d.dr * grid_.stride + d.dc);
+        }
+        return count;
+    }
+
+    unsigned count_boxes(const std::pmr::vector<uint64_t> & boxes) const
+    {
+        unsigned count = 0;
+        for (const uint64_t box : boxes)
+            count += look2(grid_, box / grid_.columns, box % grid_.columns);
+        return count;
+    }
+};
+#endif
 
-    for (unsigned r = 0; r < input.rows - 2; ++r)
-        for (unsigned c = 0; c < input.columns - 2; ++c)
-            total_x_mases += look2(r, c);
+
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
+{
+    input = make_grid(text);
+    return input.rows > 0;
 }
 
 
+// my puzzle answers
+constexpr unsigned part1_answer = 2521;
+constexpr unsigned part2_answer = 1912;
+
 
+
+#ifndef ALL_DAYS
 int main()
 {
-    std::string input_text;
-    //input_text.reserve(total_rows * total_columns);
-    std::ifstream input_file("input04.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
+    const mapped_file input_file("input04.txt");
     input_data input;
-    for (std::string line; std::getline(input_file, line); ) {
-        input.text += line;
-        ++input.rows;
-        input.columns = line.size();
-    }
-
-
-    const auto start_time = std::chrono::high_resolution_clock::now();
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     unsigned part1_count = 0;
     unsigned part2_count = 0;
 
-    const int repetitions = 1000;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_count, part2_count);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+#ifdef USE_INCREMENTAL
+    // change every cell in turn to the next letter and back again, one update
+    // at a time; the time is for all the updates, with both answers up to
+    // date after each one
+    xmas_grid grid(input);
+    const auto timing = benchmark("04", [&] {
+        for (unsigned r = 0; r < input.rows; ++r)
+            for (unsigned c = 0; c < input.columns; ++c) {
+                const char letter = input(r, c);
+                const xmas_grid::cell_update change{r, c, "MASX"[std::string_view("XMAS").find(letter) % 4]};
+                grid.update(std::span(&change, 1));
+                const xmas_grid::cell_update restore{r, c, letter};
+                grid.update(std::span(&restore, 1));
+            }
+    });
+    part1_count = grid.total_xmases();
+    part2_count = grid.total_x_mases();
+#else
+    const auto timing = benchmark("04", [&] { solve(input, part1_count, part2_count); });
+#endif
 
     std::cout << part1_count << '\n';
-    assert(part1_count == 2521);
+    assert(part1_count == part1_answer);
     std::cout << part2_count << '\n';
-    assert(part2_count == 1912);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_count == part2_answer);
+    std::cout << timing << '\n';
 }
+#endif
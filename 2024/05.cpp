@@ -2,13 +2,20 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
+#include <memory_resource>
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
+#include "tokenizer.h"
+#ifdef USE_STREAMING
+#include "record_stream.h"
+#endif
 
 
 struct input_data {
@@ -16,19 +23,18 @@ struct input_data {
     std::vector<std::vector<unsigned>> updates;
 };
 
-void solve(const input_data & input, unsigned & part1_result, unsigned & part2_result)
+// return true iff the ordering rules say page first must be printed before page second
+bool must_preceed(const input_data & input, unsigned first, unsigned second)
 {
-    part1_result = part2_result = 0;
-
-    // part 1
+    auto order = input.ordering.find(first);
+    if (order != input.ordering.end())
+        return order->second.contains(second);
+    return false;
+}
 
-    auto must_preceed = [&](unsigned first, unsigned second) {
-        auto order = input.ordering.find(first);
-        if (order != input.ordering.end())
-            return order->second.contains(second);
-        return false;
-    };
-    
+// return true iff no page in the given update must be printed before one ahead of it
+bool in_order(const input_data & input, const std::vector<unsigned> & update)
+{
     // Note: although std::is_sorted() gives the correct result with my input,
     // (which is suprising?) it would not detect that 10|42 42,99,10 is not
     // sorted. The puzzle text says "The notation X|Y means that if both page
@@ -36,21 +42,17 @@ void solve(const input_data & input, unsigned & part1_result, unsigned & part2_r
     // page number X must be printed at some point before page number Y." And
     // also "47|53 [...] 47 doesn't necessarily need to be immediately before
     // 53; other pages are allowed to be between them."
-    auto is_sorted = [&](auto begin, auto end, auto less) {
-        for (; begin != end; ++begin)
-            for (auto i = std::next(begin); i != end; ++i)
-                if (less(*i, *begin))
-                    return false;
-        return true;
-    };
-
-    for (const auto & update : input.updates)
-        if (is_sorted(update.begin(), update.end(), must_preceed))
-            part1_result += update[update.size() / 2];
-
-
-    // part 2
+    for (auto begin = update.begin(); begin != update.end(); ++begin)
+        for (auto i = std::next(begin); i != update.end(); ++i)
+            if (must_preceed(input, *i, *begin))
+                return false;
+    return true;
+}
 
+// put the pages of the given update in order into sorted; unsorted is scratch space
+void put_in_order(const input_data & input, const std::vector<unsigned> & update,
+    std::pmr::vector<unsigned> & sorted, std::pmr::vector<unsigned> & unsorted)
+{
     // Note: std::stable_sort() gives the correct puzzle answer for my input!
     // But std::stable_sort() will NOT correctly sort
     //     10|42
@@ -61,78 +63,164 @@ void solve(const input_data & input, unsigned & part1_result, unsigned & part2_r
     // instead of the required
     //     20,10,42,99,98
 
-    for (const auto & update : input.updates) {
-        if (!is_sorted(update.begin(), update.end(), must_preceed)) {
-            std::vector<unsigned> sorted{update};
-
-            for (bool found_out_of_order = true; found_out_of_order;) {
-                found_out_of_order = false;
-                constexpr unsigned removed = 999999;
-                std::vector<unsigned> unsorted{sorted};
-                for (int src = 0, dst = 0; src != unsorted.size(); ++src) {
-                    if (unsorted[src] == removed)
-                        continue;
-                    for (int s = src + 1; s != unsorted.size(); ++s) {
-                        if (unsorted[s] == removed)
-                            continue;
-                        if (must_preceed(unsorted[s], unsorted[src])) {
-                            sorted[dst++] = unsorted[s];
-                            unsorted[s] = removed;
-                            found_out_of_order = true;
-                        }
-                    }
-                    sorted[dst++] = unsorted[src];
+    sorted.assign(update.begin(), update.end());
+
+    for (bool found_out_of_order = true; found_out_of_order;) {
+        found_out_of_order = false;
+        constexpr unsigned removed = 999999;
+        unsorted.assign(sorted.begin(), sorted.end());
+        for (int src = 0, dst = 0; src != unsorted.size(); ++src) {
+            if (unsorted[src] == removed)
+                continue;
+            for (int s = src + 1; s != unsorted.size(); ++s) {
+                if (unsorted[s] == removed)
+                    continue;
+                if (must_preceed(input, unsorted[s], unsorted[src])) {
+                    sorted[dst++] = unsorted[s];
+                    unsorted[s] = removed;
+                    found_out_of_order = true;
                 }
             }
+            sorted[dst++] = unsorted[src];
+        }
+    }
+}
+
+
+void solve(const input_data & input, unsigned & part1_result, unsigned & part2_result)
+{
+    part1_result = part2_result = 0;
+
+    scratch_arena arena;
+
+    // part 1
+    perf_part("part 1");
+
+    for (const auto & update : input.updates)
+        if (in_order(input, update))
+            part1_result += update[update.size() / 2];
+
+
+    // part 2
+    perf_part("part 2");
 
+    std::pmr::vector<unsigned> sorted(&arena);
+    std::pmr::vector<unsigned> unsorted(&arena);
+    for (const auto & update : input.updates) {
+        if (!in_order(input, update)) {
+            put_in_order(input, update, sorted, unsorted);
             part2_result += sorted[sorted.size() / 2];
         }
     }
 }
 
 
+// read the X|Y rules at the start of the puzzle input text into input and
+// return the position of the updates that follow them, or npos if there are none
+size_t parse_rules(std::string_view text, input_data & input)
+{
+    // the X|Y rules are separated from the updates by an empty line
+    const size_t rules_end = text.find("\n\n");
+    if (rules_end == std::string_view::npos)
+        return rules_end;
+
+    std::vector<unsigned> numbers;
+    tokenize_numbers(text.substr(0, rules_end), numbers);
+    for (unsigned i = 0; i + 1 < numbers.size(); i += 2)
+        input.ordering[numbers[i]].insert(numbers[i + 1]);
+    return rules_end + 2;
+}
 
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
+{
+    const size_t updates_start = parse_rules(text, input);
+    if (updates_start == std::string_view::npos)
+        return false;
+
+    std::vector<unsigned> numbers;
+    std::vector<uint32_t> line_ends;
+    tokenize_numbers(text.substr(updates_start), numbers, &line_ends);
+    for (uint32_t line_start = 0; const uint32_t line_end : line_ends) {
+        input.updates.emplace_back(numbers.begin() + line_start, numbers.begin() + line_end);
+        line_start = line_end;
+    }
+    return true;
+}
+
+
+#ifdef USE_STREAMING
+// solve the puzzle while the input text is still being read: the rules are
+// read first, then each update is checked (and if need be put in order) as
+// soon as the reader thread has parsed it; return false if the input isn't as
+// expected
+bool solve_streaming(std::string_view text, unsigned & part1_result, unsigned & part2_result)
+{
+    part1_result = part2_result = 0;
+
+    input_data rules;
+    const size_t updates_start = parse_rules(text, rules);
+    if (updates_start == std::string_view::npos)
+        return false;
+
+    scratch_arena arena;
+    std::pmr::vector<unsigned> sorted(&arena);
+    std::pmr::vector<unsigned> unsorted(&arena);
+    return stream_records<std::vector<unsigned>>(text.substr(updates_start),
+        [](std::string_view line, std::vector<unsigned> & update) {
+            for (unsigned page; next_number(line, page); )
+                update.push_back(page);
+            return !update.empty();
+        },
+        [&](const std::vector<unsigned> & update) {
+            if (in_order(rules, update))
+                part1_result += update[update.size() / 2];
+            else {
+                put_in_order(rules, update, sorted, unsorted);
+                part2_result += sorted[sorted.size() / 2];
+            }
+        });
+}
+#endif
+
+
+// my puzzle answers
+constexpr unsigned part1_answer = 4185;
+constexpr unsigned part2_answer = 4480;
+
+
+
+#ifndef ALL_DAYS
 int main()
 {
-    std::string input_text;
-    std::ifstream input_file("input05.txt");
+    const mapped_file input_file("input05.txt");
+#ifdef USE_STREAMING
     if (!input_file.is_open())
         return EXIT_FAILURE;
-    input_data input;
-    std::string line;
-    while (std::getline(input_file, line) && !line.empty()) {
-        std::istringstream reader(line);
-        unsigned a, b; char bar;
-        reader >> a >> bar >> b;
-        input.ordering[a].insert(b);
-    }
-    while (std::getline(input_file, line)) {
-        std::istringstream reader(line);
-        std::vector<unsigned> update;
-        unsigned a;
-        while (reader >> a) {
-            update.push_back(a);
-            char comma;
-            reader >> comma;
-        }
-        input.updates.emplace_back(update);
-    }
 
+    unsigned part1_result = 0;
+    unsigned part2_result = 0;
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+    // (the time includes reading the input, which overlaps with solving)
+    bool input_ok = true;
+    const auto timing = benchmark("05", [&] { input_ok = solve_streaming(input_file.text(), part1_result, part2_result); });
+    if (!input_ok)
+        return EXIT_FAILURE;
+#else
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     unsigned part1_result = 0;
     unsigned part2_result = 0;
 
-    const int repetitions = 1000;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("05", [&] { solve(input, part1_result, part2_result); });
+#endif
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 4185);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 4480);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
+#endif
@@ -2,14 +2,17 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <memory_resource>
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
 
 
 
@@ -26,7 +29,10 @@ void solve(const input_data & input, unsigned & part1_result, unsigned & part2_r
 {
     part1_result = part2_result = 0;
 
+    scratch_arena arena;
+
     // part 1
+    perf_part("part 1");
 
     enum heading {N, E, S, W};
     heading head = N;
@@ -38,7 +44,7 @@ void solve(const input_data & input, unsigned & part1_result, unsigned & part2_r
     };
     heading turn_right[] = {E, S, W, N};
 
-    std::vector<bool> visited(input.map.size(), false);
+    std::pmr::vector<bool> visited(input.map.size(), false, &arena);
     visited[input.start_at] = true;
     part1_result = 1;
 
@@ -59,9 +65,10 @@ void solve(const input_data & input, unsigned & part1_result, unsigned & part2_r
 
 
     // part 2
+    perf_part("part 2");
 
     constexpr char untrodden = -1;
-    std::vector<char> path(input.map.size());
+    std::pmr::vector<char> path(input.map.size(), &arena);
     const int last_location = input.map.size() - input.map_width;
     for (int obstacle_location = input.map_width; obstacle_location < last_location; ) {
         if (visited[obstacle_location] && obstacle_location != input.start_at) {
@@ -92,50 +99,53 @@ void solve(const input_data & input, unsigned & part1_result, unsigned & part2_r
 }
 
 
-
-int main()
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
 {
-    std::string input_text;
-    std::ifstream input_file("input06.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
-
-    input_data input;
-    std::string line;
-    std::getline(input_file, line);
-    input.map_width = line.size() + 1;
+    const grid_view grid = make_grid(text);
+    input.map_width = grid.columns + 1;
+    input.map.reserve((grid.rows + 2) * input.map_width);
     input.map.resize(input.map_width);
     std::fill(input.map.begin(), input.map.end(), off_the_map);
-    for (auto c : line)
-        input.map.push_back(c);
-    input.map.push_back(off_the_map);
 
-    while (std::getline(input_file, line) && !line.empty()) {
-        for (auto c : line)
-            input.map.push_back(c);
+    for (unsigned r = 0; r < grid.rows; ++r) {
+        const std::string_view line = grid.text.substr(r * grid.stride, grid.columns);
+        input.map.insert(input.map.end(), line.begin(), line.end());
         input.map.push_back(off_the_map);
     }
 
-    for (unsigned i = 0; i < input.map_width; ++i)
+    for (int i = 0; i < input.map_width; ++i)
         input.map.push_back(off_the_map);
 
-    input.start_at = std::distance(input.map.begin(), std::find(input.map.begin(), input.map.end(), '^'));
+    const auto start = std::find(input.map.begin(), input.map.end(), '^');
+    input.start_at = std::distance(input.map.begin(), start);
+    return start != input.map.end();
+}
+
+
+// my puzzle answers
+constexpr unsigned part1_answer = 5212;
+constexpr unsigned part2_answer = 1767;
 
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+
+#ifndef ALL_DAYS
+int main()
+{
+    const mapped_file input_file("input06.txt");
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     unsigned part1_result = 0;
     unsigned part2_result = 0;
 
-    const int repetitions = 10;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("06", [&] { solve(input, part1_result, part2_result); });
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 5212);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 1767);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
+#endif
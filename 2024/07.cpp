@@ -2,15 +2,20 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
 #include <utility>
 
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "tokenizer.h"
+#ifdef USE_STREAMING
+#include "record_stream.h"
+#endif
+
 
 /*
     "some young elephants were playing nearby and stole all the operators
@@ -39,6 +44,60 @@ struct input_data {
     std::vector<equation> tests;
 };
 
+// return true iff some combination of + and * operators gives the test answer
+bool solvable(const input_data::equation & test)
+{
+    uint_least32_t operator_combinations = 1 << (test.terms.size() - 1);
+    while (operator_combinations--) {
+        auto term = test.terms.begin();
+        uint_least64_t result = *term++;
+        for (unsigned op = 1; term != test.terms.end(); ++term, op <<= 1) {
+            if (operator_combinations & op)
+                result *= *term;
+            else
+                result += *term;
+        }
+        if (result == test.answer)
+            return true; // there is at least one combination of operators that gives the specified answer
+    }
+    return false;
+}
+
+// return true iff some combination of +, * and || operators gives the test answer
+bool solvable_with_concatenation(const input_data::equation & test)
+{
+    uint_least64_t operator_combinations = 1 << (test.terms.size() - 1) * 2; // 2 bits per operator
+    while (operator_combinations--) {
+        // replace all 11b operator indexes with 10b; we only want indexes 0, 1 and 2
+        operator_combinations &= ~((operator_combinations & 0xAAAAAAAAAAAAAAAAULL) >> 1);
+
+        auto term = test.terms.begin();
+        uint_least64_t result = *term++;
+        for (uint_least64_t op = operator_combinations; term != test.terms.end(); ++term, op >>= 2) {
+            switch (op & 3) {
+            case 0: result *= *term;    break;
+            case 1: result += *term;    break;
+            default:
+                // concatenation operator
+                unsigned t = *term;
+                do {
+                    result *= 10;
+                    t /= 10;
+                } while (t);
+                result += *term;
+                break;
+            }
+            if (result > test.answer)
+                break; // (all terms appear to be positive - no point continuing if result is already too big)
+        }
+
+        if (result == test.answer)
+            return true;
+    }
+    return false;
+}
+
+
 void solve(const input_data & input, uint_least64_t & part1_result, uint_least64_t & part2_result)
 {
     part1_result = part2_result = 0;
@@ -47,111 +106,118 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
     std::vector<bool> found_solution(input.tests.size(), false);
 
     // part 1
+    perf_part("part 1");
 
     for (int i = 0; i < input.tests.size(); ++i) {
-        const auto & test = input.tests[i];
-        uint_least32_t operator_combinations = 1 << (test.terms.size() - 1);
-        while (operator_combinations--) {
-            auto term = test.terms.begin();
-            uint_least64_t result = *term++;
-            for (unsigned op = 1; term != test.terms.end(); ++term, op <<= 1) {
-                if (operator_combinations & op)
-                    result *= *term;
-                else
-                    result += *term;
-            }
-            if (result == test.answer) {
-                // there is at least one combination of operators that gives the specified answer
-                part1_result += result;
-                found_solution[i] = true;
-                break;
-            }
+        if (solvable(input.tests[i])) {
+            part1_result += input.tests[i].answer;
+            found_solution[i] = true;
         }
     }
 
 
     // part 2
+    perf_part("part 2");
 
     part2_result = part1_result;
 
     for (int i = 0; i < input.tests.size(); ++i) {
         if (found_solution[i])
             continue;
-        const auto & test = input.tests[i];
-
-        uint_least64_t operator_combinations = 1 << (test.terms.size() - 1) * 2; // 2 bits per operator
-        while (operator_combinations--) {
-            // replace all 11b operator indexes with 10b; we only want indexes 0, 1 and 2
-            operator_combinations &= ~((operator_combinations & 0xAAAAAAAAAAAAAAAAULL) >> 1);
-
-            auto term = test.terms.begin();
-            uint_least64_t result = *term++;
-            for (uint_least64_t op = operator_combinations; term != test.terms.end(); ++term, op >>= 2) {
-                switch (op & 3) {
-                case 0: result *= *term;    break;
-                case 1: result += *term;    break;
-                default:
-                    // concatenation operator
-                    unsigned t = *term;
-                    do {
-                        result *= 10;
-                        t /= 10;
-                    } while (t);
-                    result += *term;
-                    break;
-                }
-                if (result > test.answer)
-                    break; // (all terms appear to be positive - no point continuing if result is already too big)
-            }
-
-            if (result == test.answer) {
-                part2_result += result;
-                break;
-            }
-        }
+        if (solvable_with_concatenation(input.tests[i]))
+            part2_result += input.tests[i].answer;
     }
 }
 
 
-
-int main()
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
 {
-    std::ifstream input_file("input07.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
-    input_data input;
-    std::string line;
-    while (std::getline(input_file, line) && !line.empty()) {
-        std::istringstream reader(line);
+    std::vector<uint_least64_t> numbers;
+    std::vector<uint32_t> line_ends;
+    tokenize_numbers(text, numbers, &line_ends);
+    for (uint32_t line_start = 0; const uint32_t line_end : line_ends) {
+        if (line_start == line_end)
+            break;
         input_data::equation equ;
-        char colon;
-        reader >> equ.answer >> colon;
-        unsigned term;
-        while (reader >> term)
-            equ.terms.push_back(term);
+        equ.answer = numbers[line_start];
+        equ.terms.assign(numbers.begin() + line_start + 1, numbers.begin() + line_end);
+        line_start = line_end;
         if (equ.terms.size() < 2)
-            return EXIT_FAILURE; // (this implementation expects at least 2 terms)
+            return false; // (this implementation expects at least 2 terms)
         if (equ.terms.size() > 32)
-            return EXIT_FAILURE; // (this implementation limited to 31 operators)
+            return false; // (this implementation limited to 31 operators)
         input.tests.emplace_back(equ);
     }
+    return true;
+}
+
+
+#ifdef USE_STREAMING
+// solve the puzzle while the input text is still being read: each equation is
+// tested as soon as the reader thread has parsed it; return false if the
+// input isn't as expected
+bool solve_streaming(std::string_view text, uint_least64_t & part1_result, uint_least64_t & part2_result)
+{
+    part1_result = part2_result = 0;
+    return stream_records<input_data::equation>(text,
+        [](std::string_view line, input_data::equation & equ) {
+            if (!next_number(line, equ.answer))
+                return false;
+            for (unsigned term; next_number(line, term); )
+                equ.terms.push_back(term);
+            // (this implementation expects at least 2 terms and is limited to 31 operators)
+            return equ.terms.size() >= 2 && equ.terms.size() <= 32;
+        },
+        [&](const input_data::equation & test) {
+            if (solvable(test)) {
+                part1_result += test.answer;
+                part2_result += test.answer;
+            }
+            else if (solvable_with_concatenation(test))
+                part2_result += test.answer;
+        });
+}
+#endif
+
 
+// my puzzle answers
+constexpr uint_least64_t part1_answer = 1289579105366;
+constexpr uint_least64_t part2_answer = 92148721834692;
 
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+
+#ifndef ALL_DAYS
+int main()
+{
+    const mapped_file input_file("input07.txt");
+#ifdef USE_STREAMING
+    if (!input_file.is_open())
+        return EXIT_FAILURE;
 
     uint_least64_t part1_result = 0;
     uint_least64_t part2_result = 0;
 
-    const int repetitions = 5;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
+    // (the time includes reading the input, which overlaps with solving)
+    bool input_ok = true;
+    const auto timing = benchmark("07", [&] { input_ok = solve_streaming(input_file.text(), part1_result, part2_result); });
+    if (!input_ok)
+        return EXIT_FAILURE;
+#else
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
+
+    uint_least64_t part1_result = 0;
+    uint_least64_t part2_result = 0;
 
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("07", [&] { solve(input, part1_result, part2_result); });
+#endif
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 1289579105366);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 92148721834692);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
+#endif
@@ -2,14 +2,17 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <memory_resource>
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
 
 
 /*
@@ -76,9 +79,11 @@ struct input_data {
 void solve(const input_data & input, uint_least64_t & part1_result, uint_least64_t & part2_result)
 {
     part1_result = part2_result = 0;
+    scratch_arena arena;
 
 
     // part 1
+    perf_part("part 1");
 
     auto on_map = [&](int r, int c) {
         return 0 <= r && r < input.map_rows
@@ -86,7 +91,7 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
     };
 
     // find the antennas
-    std::unordered_map<char, std::vector<std::pair<int, int>>> antennas;
+    std::pmr::unordered_map<char, std::pmr::vector<std::pair<int, int>>> antennas(&arena);
     for (int r = 0; r < input.map_rows; ++r) {
         for (int c = 0; c < input.map_cols; ++c) {
             const char frequency = input.map[r * input.map_cols + c];
@@ -96,7 +101,7 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
     }
 
     // find the antinodes
-    std::unordered_set<int> antinodes;
+    std::pmr::unordered_set<int> antinodes(&arena);
     for (const auto & [_, locations] : antennas) {
         for (auto [r1, c1] : locations) {
             for (auto [r2, c2] : locations) {
@@ -114,6 +119,7 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
 
 
     // part 2
+    perf_part("part 2");
 
     // find the antinodes
     antinodes.clear();
@@ -137,40 +143,44 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
 }
 
 
-
-int main()
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
 {
-    std::ifstream input_file("input08.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
-
-    input_data input;
-    std::string line;
-    std::getline(input_file, line);
-    input.map_cols = line.size();
-    input.map_rows = 0;
-    do {
+    const grid_view grid = make_grid(text);
+    input.map_cols = grid.columns;
+    input.map_rows = grid.rows;
+    input.map.reserve(grid.rows * grid.columns);
+    for (unsigned r = 0; r < grid.rows; ++r) {
+        const std::string_view line = grid.text.substr(r * grid.stride, grid.columns);
         input.map.insert(input.map.end(), line.begin(), line.end());
-        ++input.map_rows;
-    } while (std::getline(input_file, line) && !line.empty());
+    }
+    return true;
+}
 
 
+// my puzzle answers
+constexpr uint_least64_t part1_answer = 376;
+constexpr uint_least64_t part2_answer = 1352;
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+
+
+#ifndef ALL_DAYS
+int main()
+{
+    const mapped_file input_file("input08.txt");
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     uint_least64_t part1_result = 0;
     uint_least64_t part2_result = 0;
 
-    const int repetitions = 100;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("08", [&] { solve(input, part1_result, part2_result); });
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 376);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 1352);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
-
+#endif
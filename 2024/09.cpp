@@ -2,14 +2,17 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <memory_resource>
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
 
 
 /*
@@ -60,7 +63,7 @@ struct input_data {
     std::vector<char> map;
 
     input_data() = default;
-    input_data(const std::string & s)
+    input_data(std::string_view s)
         : map(s.begin(), s.end())
     {}
 };
@@ -68,12 +71,14 @@ struct input_data {
 void solve(const input_data & input, uint_least64_t & part1_result, uint_least64_t & part2_result)
 {
     part1_result = part2_result = 0;
+    scratch_arena arena;
 
 
     // part 1
+    perf_part("part 1");
 
     // create block id map (00...111...2...333.44.5555.6666.777.888899)
-    std::vector<int> block_id_map;
+    std::pmr::vector<int> block_id_map(&arena);
     block_id_map.reserve(input.map.size() * 9);
     constexpr int free_block_id = -1;
     int file_id = 0;
@@ -85,7 +90,7 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
     }
 
     // compact map
-    std::vector<int> compacted_map{block_id_map};
+    std::pmr::vector<int> compacted_map(block_id_map, &arena);
     for (int left = 0, right = compacted_map.size() - 1; left < right; ) {
         if (compacted_map[left] != free_block_id) {
             ++left;
@@ -100,7 +105,7 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
     }
 
     // calculate checksum
-    auto checksum = [&](const std::vector<int> & map) {
+    auto checksum = [&](const std::pmr::vector<int> & map) {
         uint_least64_t csum = 0;
         for (unsigned block_index = 0; block_index < map.size(); ++block_index) {
             if (map[block_index] == free_block_id)
@@ -114,6 +119,7 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
 
 
     // part 2
+    perf_part("part 2");
 
     int first_free = 0;  // block index of first block in first free space
     int last_file = block_id_map.size() - 1; // index of first block in last file
@@ -170,33 +176,38 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
 }
 
 
-
-int main()
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
 {
-    std::ifstream input_file("input09.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
-    std::string line;
-    std::getline(input_file, line);
-    input_data input{line};
+    const std::string_view line = *lines(text).begin();
+    input.map.assign(line.begin(), line.end());
+    return !line.empty();
+}
+
 
+// my puzzle answers
+constexpr uint_least64_t part1_answer = 6225730762521;
+constexpr uint_least64_t part2_answer = 6250605700557;
 
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+
+#ifndef ALL_DAYS
+int main()
+{
+    const mapped_file input_file("input09.txt");
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     uint_least64_t part1_result = 0;
     uint_least64_t part2_result = 0;
 
-    const int repetitions = 10;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("09", [&] { solve(input, part1_result, part2_result); });
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 6225730762521);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 6250605700557);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
-
+#endif
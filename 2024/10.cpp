@@ -2,14 +2,17 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <memory_resource>
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
 
 
 /*
@@ -50,16 +53,22 @@ struct input_data {
 void solve(const input_data & input, uint_least64_t & part1_result, uint_least64_t & part2_result)
 {
     part1_result = part2_result = 0;
+    scratch_arena arena;
 
 
     // parts 1 and 2 combined
+    perf_part("parts 1 and 2");
+
+    // (shared by every trailhead so that their memory is reused)
+    std::pmr::unordered_set<unsigned> summits_reached(&arena);
+    std::pmr::vector<unsigned> unexplored(&arena);
 
     // return the number of unique summits and trails reachable from the given trailhead map index
     auto count_reachable_summits = [&](unsigned start_index) {
 
         unsigned count = 0;
-        std::unordered_set<unsigned> summits_reached;
-        std::vector<unsigned> unexplored;
+        summits_reached.clear();
+        unexplored.clear();
         unexplored.push_back(start_index);
 
         auto check = [&](unsigned next_step, unsigned index) {
@@ -99,40 +108,43 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
 }
 
 
-
-int main()
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
 {
-    std::ifstream input_file("input10.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
-    input_data input;
-    std::string line;
-    std::getline(input_file, line);
-    input.map_cols = line.size();
-    input.map_rows = 0;
-    do {
-        for (auto c : line)
-            input.map.push_back(c - '0');
-        ++input.map_rows;
-    } while (std::getline(input_file, line) && !line.empty());
+    const grid_view grid = make_grid(text);
+    input.map_cols = grid.columns;
+    input.map_rows = grid.rows;
+    input.map.reserve(grid.rows * grid.columns);
+    for (unsigned r = 0; r < grid.rows; ++r)
+        for (unsigned c = 0; c < grid.columns; ++c)
+            input.map.push_back(grid(r, c) - '0');
+    return true;
+}
+
 
+// my puzzle answers
+constexpr uint_least64_t part1_answer = 754;
+constexpr uint_least64_t part2_answer = 1609;
 
 
-    const auto start_time = std::chrono::high_resolution_clock::now();
+
+#ifndef ALL_DAYS
+int main()
+{
+    const mapped_file input_file("input10.txt");
+    input_data input;
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     uint_least64_t part1_result = 0;
     uint_least64_t part2_result = 0;
 
-    const int repetitions = 1000;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("10", [&] { solve(input, part1_result, part2_result); });
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 754);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 1609);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
-
+#endif
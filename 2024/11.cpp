@@ -2,15 +2,17 @@
 
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
-#include <chrono>
 #include <string>
 #include <unordered_set>
 #include <utility>
 
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "tokenizer.h"
+
 
 /*
     "Every time you blink, the stones each simultaneously change according to the
@@ -165,38 +167,45 @@ void solve(const input_data & input, uint_least64_t & part1_result, uint_least64
     part1_result = stones.size();
 #endif
 
+    perf_part("part 1");
     part1_result = total_stones_after_n_blinks(input.stones, 25);
 
+    perf_part("part 2");
     part2_result = total_stones_after_n_blinks(input.stones, 75);
 }
 
 
+// read the puzzle input text into input; return false if it isn't as expected
+bool parse_input(std::string_view text, input_data & input)
+{
+    tokenize_numbers(text, input.stones);
+    return !input.stones.empty();
+}
+
+
+// my puzzle answers
+constexpr uint_least64_t part1_answer = 193899;
+constexpr uint_least64_t part2_answer = 229682160383225;
+
+
 
+#ifndef ALL_DAYS
 int main()
 {
-    std::ifstream input_file("input11.txt");
-    if (!input_file.is_open())
-        return EXIT_FAILURE;
+    const mapped_file input_file("input11.txt");
     input_data input;
-    for (uint_least64_t n = 0; input_file >> n; )
-        input.stones.push_back(n);
-
-
-    const auto start_time = std::chrono::high_resolution_clock::now();
+    if (!input_file.is_open() || !parse_input(input_file.text(), input))
+        return EXIT_FAILURE;
 
     uint_least64_t part1_result = 0;
     uint_least64_t part2_result = 0;
 
-    const int repetitions = 100;
-    for (int i = 0; i < repetitions; ++i)
-        solve(input, part1_result, part2_result);
-
-    const std::chrono::duration<double, std::milli> ms = std::chrono::high_resolution_clock::now() - start_time;
+    const auto timing = benchmark("11", [&] { solve(input, part1_result, part2_result); });
 
     std::cout << part1_result << '\n';
-    assert(part1_result == 193899);
+    assert(part1_result == part1_answer);
     std::cout << part2_result << '\n';
-    assert(part2_result == 229682160383225);
-    std::cout << ms.count() / repetitions << "ms\n";
+    assert(part2_result == part2_answer);
+    std::cout << timing << '\n';
 }
-
+#endif
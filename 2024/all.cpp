@@ -0,0 +1,577 @@
+// run all the 2024 puzzles, one after the other or all at once, and see how
+// long they take altogether
+//
+//     clang++ -std=c++20 -pedantic -O2 -o all all.cpp
+//     ./all               (run the days one after the other)
+//     ./all --parallel    (run the days concurrently, one per core)
+//     ./all --generate DAY SCALE [SEED]
+//                         (write a generated input for the given day to stdout)
+//     ./all --sweep [--max-scale N] [--seed N] [DAY...]
+//                         (time each day on generated inputs of increasing size)
+//
+// Each day's NN.cpp is compiled in here, in its own namespace dayNN, with
+// ALL_DAYS defined to leave out its main(). Every standard header any day
+// includes must be included here first, at global scope, so that the
+// day's own #includes do nothing inside its namespace.
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <regex>
+#include <utility>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <bit>
+#include <span>
+#include <barrier>
+#include <numeric>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "benchmark.h"
+#include "mapped_file.h"
+#include "scratch_arena.h"
+#include "record_stream.h"
+#include "thread_pool.h"
+#include "tokenizer.h"
+#include "token_matcher.h"
+#include "word_search.h"
+#include "generate.h"
+
+#define ALL_DAYS
+namespace day01 {
+#include "01.cpp"
+}
+namespace day02 {
+#include "02.cpp"
+}
+namespace day03 {
+#include "03.cpp"
+}
+namespace day04 {
+#include "04.cpp"
+}
+namespace day05 {
+#include "05.cpp"
+}
+namespace day06 {
+#include "06.cpp"
+}
+namespace day07 {
+#include "07.cpp"
+}
+namespace day08 {
+#include "08.cpp"
+}
+namespace day09 {
+#include "09.cpp"
+}
+namespace day10 {
+#include "10.cpp"
+}
+namespace day11 {
+#include "11.cpp"
+}
+#undef ALL_DAYS
+
+
+struct day_result {
+    bool input_ok = false;
+    std::string part1, part2;
+    bool part1_ok = false, part2_ok = false;
+    double parse_ms = 0;
+    double solve_ms = 0;
+};
+
+struct day {
+    std::string name;
+    std::function<day_result(std::string_view text)> run; // (parse and solve the given input)
+    std::function<benchmark_result(std::string_view text, bool & answers_ok)> bench; // (parse, then time solve() repeatedly)
+};
+
+
+template <typename T>
+std::string to_string(const T & value)
+{
+    std::ostringstream os;
+    os << value;
+    return os.str();
+}
+
+// read the given input text with the given day's parse_input(), solve it once
+// with the given solve() and check the results against the given answers
+template <typename Input, typename Result1, typename Result2, typename Parse, typename Solve>
+day_result run_day(std::string_view text, Parse parse_input, Solve solve, Result1 part1_answer, Result2 part2_answer)
+{
+    using clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    day_result result;
+    const auto start = clock::now();
+    Input input{};
+    result.input_ok = parse_input(text, input);
+    const auto parsed = clock::now();
+    result.parse_ms = milliseconds(parsed - start).count();
+    if (!result.input_ok)
+        return result;
+
+    Result1 part1_result{};
+    Result2 part2_result{};
+    solve(input, part1_result, part2_result);
+    result.solve_ms = milliseconds(clock::now() - parsed).count();
+
+    result.part1 = to_string(part1_result);
+    result.part2 = to_string(part2_result);
+    result.part1_ok = part1_result == part1_answer;
+    result.part2_ok = part2_result == part2_answer;
+    return result;
+}
+
+// read the given input text with the given day's parse_input(), then time
+// the given solve() with benchmark(); set answers_ok iff the results are right
+template <typename Input, typename Result1, typename Result2, typename Parse, typename Solve>
+benchmark_result benchmark_day(const std::string & name, std::string_view text, Parse parse_input, Solve solve,
+    Result1 part1_answer, Result2 part2_answer, bool & answers_ok)
+{
+    Input input{};
+    answers_ok = parse_input(text, input);
+    if (!answers_ok)
+        return {};
+    Result1 part1_result{};
+    Result2 part2_result{};
+    benchmark_options options;
+    options.write_json = false;
+    const benchmark_result result = benchmark(name, [&] { solve(input, part1_result, part2_result); }, options);
+    answers_ok = part1_result == part1_answer && part2_result == part2_answer;
+    return result;
+}
+
+#define DAY(NN, SOLVE) \
+    day{#NN, [](std::string_view text) { \
+        return run_day<day##NN::input_data>(text, day##NN::parse_input, SOLVE, \
+            day##NN::part1_answer, day##NN::part2_answer); \
+    }, [](std::string_view text, bool & answers_ok) { \
+        return benchmark_day<day##NN::input_data>(#NN, text, day##NN::parse_input, SOLVE, \
+            day##NN::part1_answer, day##NN::part2_answer, answers_ok); \
+    }}
+
+const std::vector<day> all_days = {
+    DAY(01, [](const auto & input, auto & part1, auto & part2) { day01::solve(input, part1, part2); }),
+    DAY(02, [](const auto & input, auto & part1, auto & part2) { day02::solve(input, part1, part2); }),
+    DAY(03, [](const auto & input, auto & part1, auto & part2) { day03::solve(input, part1, part2); }),
+    DAY(04, [](const auto & input, auto & part1, auto & part2) { day04::solve(input, part1, part2); }),
+    DAY(05, [](const auto & input, auto & part1, auto & part2) { day05::solve(input, part1, part2); }),
+    DAY(06, [](const auto & input, auto & part1, auto & part2) { day06::solve(input, part1, part2); }),
+    DAY(07, [](const auto & input, auto & part1, auto & part2) { day07::solve(input, part1, part2); }),
+    DAY(08, [](const auto & input, auto & part1, auto & part2) { day08::solve(input, part1, part2); }),
+    DAY(09, [](const auto & input, auto & part1, auto & part2) { day09::solve(input, part1, part2); }),
+    DAY(10, [](const auto & input, auto & part1, auto & part2) { day10::solve(input, part1, part2); }),
+    DAY(11, [](const auto & input, auto & part1, auto & part2) { day11::solve(input, part1, part2); }),
+};
+
+#undef DAY
+
+
+// run the given day on its real input, inputNN.txt
+day_result run_day_input(const day & d)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const mapped_file input_file(("input" + d.name + ".txt").c_str());
+    if (!input_file.is_open())
+        return {};
+    const std::chrono::duration<double, std::milli> map_ms = std::chrono::steady_clock::now() - start;
+    day_result result = d.run(input_file.text());
+    result.parse_ms += map_ms.count();
+    return result;
+}
+
+
+// run all days, sequentially or spread over the available cores
+std::vector<day_result> run_all_days(bool parallel)
+{
+    std::vector<day_result> results(all_days.size());
+    if (!parallel) {
+        for (unsigned i = 0; i < all_days.size(); ++i)
+            results[i] = run_day_input(all_days[i]);
+        return results;
+    }
+
+    // each worker takes the next day not yet started until there are none left;
+    // the days are in roughly increasing order of difficulty, so start at the end
+    std::atomic<unsigned> days_started = 0;
+    auto worker = [&] {
+        for (unsigned n; (n = days_started++) < all_days.size(); ) {
+            const unsigned i = all_days.size() - 1 - n;
+            results[i] = run_day_input(all_days[i]);
+        }
+    };
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::min<unsigned>(cores, all_days.size()); ++i)
+        workers.emplace_back(worker);
+    for (auto & w : workers)
+        w.join();
+    return results;
+}
+
+
+// time the given day on generated inputs 1, 10, 100... times the size of the
+// real input, up to max_scale or until a run would take longer than time_limit_ms;
+// print a table and a log-log plot of time against input size and write the
+// figures to sweepNN.csv
+void sweep(const day & d, double max_scale, uint64_t seed, double time_limit_ms = 10000)
+{
+    struct point {
+        double scale;
+        size_t bytes;
+        double parse_ms, solve_ms;
+    };
+    std::vector<point> points;
+    for (double scale = 1; scale <= max_scale; scale *= 10) {
+        const std::string text = generate_input(std::stoi(d.name), scale, seed);
+        // (take the best of a few runs while they're quick)
+        day_result best;
+        for (int run = 0; run < 3; ++run) {
+            const day_result r = d.run(text);
+            if (run == 0 || r.solve_ms < best.solve_ms)
+                best = r;
+            if (r.parse_ms + r.solve_ms > 1000)
+                break;
+        }
+        points.push_back({scale, text.size(), best.parse_ms, best.solve_ms});
+
+        // predict the time for the next size from the growth so far (assuming it's at least linear)
+        double exponent = 1;
+        if (points.size() > 1) {
+            const point & previous = points[points.size() - 2];
+            if (previous.solve_ms > 0 && best.solve_ms > 0)
+                exponent = std::max(1.0, std::log10(best.solve_ms / previous.solve_ms));
+        }
+        if ((best.parse_ms + best.solve_ms) * std::pow(10, exponent) > time_limit_ms)
+            break;
+    }
+
+    std::ofstream csv("sweep" + d.name + ".csv");
+    csv << "scale,bytes,parse_ms,solve_ms\n";
+    std::cout << "\nday " << d.name << "\n"
+              << "   scale       bytes   parse ms    solve ms  growth  log10(solve ms) from -3\n";
+    for (unsigned i = 0; i < points.size(); ++i) {
+        const point & p = points[i];
+        csv << p.scale << ',' << p.bytes << ',' << p.parse_ms << ',' << p.solve_ms << '\n';
+        // the growth is the local slope of the log-log plot: 1 for linear, 2 for quadratic...
+        std::ostringstream growth;
+        if (i > 0 && p.solve_ms > 0 && points[i - 1].solve_ms > 0)
+            growth << std::fixed << std::setprecision(2)
+                   << std::log(p.solve_ms / points[i - 1].solve_ms) / std::log(double(p.bytes) / points[i - 1].bytes);
+        const int bar = std::max(0, static_cast<int>(std::lround((std::log10(std::max(p.solve_ms, 1e-3)) + 3) * 6)));
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << std::setprecision(0) << p.scale
+                  << std::setw(12) << p.bytes << std::setprecision(2)
+                  << std::setw(11) << p.parse_ms
+                  << std::setw(12) << p.solve_ms
+                  << std::setw(8) << growth.str()
+                  << "  " << std::string(bar, '#') << '\n';
+    }
+    std::cout.flush();
+}
+
+
+
+// The baseline file has one line per day: the day, the median, minimum and
+// standard deviation of the time for one call to solve(), the number of timed
+// calls, and the instructions per call (0 if the hardware counters weren't
+// available when it was recorded).
+// Lines starting with # are comments.
+
+struct baseline_entry {
+    std::string name;
+    double median_ms = 0;
+    double min_ms = 0;
+    double stddev_ms = 0;
+    unsigned samples = 0;
+    double instructions = 0;
+};
+
+baseline_entry make_baseline_entry(const benchmark_result & result)
+{
+    baseline_entry entry;
+    entry.name = result.name;
+    entry.median_ms = result.median_ms;
+    entry.min_ms = result.min_ms;
+    entry.stddev_ms = result.stddev_ms;
+    entry.samples = result.samples_ms.size();
+    if (result.counters.available)
+        entry.instructions = result.counters.per_call.value[perf_instructions];
+    return entry;
+}
+
+std::vector<baseline_entry> read_baseline(const std::string & filename)
+{
+    std::vector<baseline_entry> baseline;
+    std::ifstream file(filename);
+    for (std::string line; std::getline(file, line); ) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream is(line);
+        baseline_entry entry;
+        if (is >> entry.name >> entry.median_ms >> entry.min_ms >> entry.stddev_ms >> entry.samples >> entry.instructions)
+            baseline.push_back(entry);
+    }
+    return baseline;
+}
+
+bool write_baseline(const std::string & filename, const std::vector<baseline_entry> & baseline)
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        return false;
+    file << "# day   median ms   min ms   stddev ms   samples   instructions per call\n";
+    for (const auto & entry : baseline)
+        file << entry.name << ' ' << entry.median_ms << ' ' << entry.min_ms << ' ' << entry.stddev_ms << ' '
+             << entry.samples << ' ' << std::fixed << std::setprecision(0) << entry.instructions
+             << std::defaultfloat << std::setprecision(6) << '\n';
+    return file.good();
+}
+
+
+constexpr double timer_resolution_ms = 0.001;
+
+// return the median time above which the given measurement counts as slower
+// than the given baseline: more than tolerance (e.g. 0.2 for 20%) slower, plus
+// three standard errors of the difference between the two so that noise on
+// either side isn't mistaken for a regression; the standard error of a median
+// is about 1.25 times that of the mean
+double regression_threshold_ms(const baseline_entry & before, const baseline_entry & after, double tolerance)
+{
+    auto standard_error = [](const baseline_entry & e) {
+        return e.samples > 0 ? 1.25 * e.stddev_ms / std::sqrt(double(e.samples)) : 0.0;
+    };
+    const double noise = std::hypot(standard_error(before), standard_error(after));
+    return before.median_ms * (1 + tolerance) + 3 * noise + timer_resolution_ms;
+}
+
+// return true if the given measurement is slower than the given baseline; the
+// median of the short days can drift a long way from one process to the next
+// (other work on the machine, where the data happens to land in memory), but
+// the minimum barely moves, so a real regression must show in both
+bool slower_than(const baseline_entry & before, const baseline_entry & after, double tolerance)
+{
+    return after.median_ms > regression_threshold_ms(before, after, tolerance)
+        && after.min_ms > before.min_ms * (1 + tolerance) + timer_resolution_ms;
+}
+
+
+// benchmark every day on its real input; if record, write the results to
+// baseline_file, otherwise compare them with those in baseline_file; return
+// false if any answer is wrong or any day is slower than its baseline
+// (a day that looks slower is measured again, up to retries more times, and
+// only counts as a regression if every measurement is slower: timings drift
+// from one run to the next by more than the noise within a run suggests)
+bool check_baseline(const std::string & baseline_file, bool record, double tolerance, unsigned retries = 2)
+{
+    const std::vector<baseline_entry> baseline = record ? std::vector<baseline_entry>{} : read_baseline(baseline_file);
+    if (!record && baseline.empty()) {
+        std::cerr << "can't read baseline " << baseline_file << '\n';
+        return false;
+    }
+
+    bool all_ok = true;
+    std::vector<baseline_entry> measured;
+    std::cout << std::fixed << std::setprecision(3)
+              << "day   median ms      min ms   stddev ms   samples" << (record ? "" : "   baseline ms   limit ms   change") << '\n';
+    for (const day & d : all_days) {
+        const mapped_file input_file(("input" + d.name + ".txt").c_str());
+        bool answers_ok = false;
+        const benchmark_result result = input_file.is_open() ? d.bench(input_file.text(), answers_ok) : benchmark_result{};
+        std::cout << std::setw(3) << d.name;
+        if (!answers_ok) {
+            std::cout << "   can't read input or WRONG ANSWER\n";
+            all_ok = false;
+            continue;
+        }
+        baseline_entry entry = make_baseline_entry(result);
+        const auto before = std::ranges::find(baseline, d.name, &baseline_entry::name);
+        unsigned attempts = 1;
+        if (!record && before != baseline.end()) {
+            for (; attempts <= retries && slower_than(*before, entry, tolerance); ++attempts) {
+                const baseline_entry again = make_baseline_entry(d.bench(input_file.text(), answers_ok));
+                if (again.median_ms < entry.median_ms)
+                    entry = again;
+            }
+        }
+        measured.push_back(entry);
+        std::cout << std::setw(12) << entry.median_ms << std::setw(12) << entry.min_ms << std::setw(12) << entry.stddev_ms << std::setw(10) << entry.samples;
+        if (!record) {
+            if (before == baseline.end())
+                std::cout << "   (not in baseline)";
+            else {
+                const double limit_ms = regression_threshold_ms(*before, entry, tolerance);
+                const bool slower = slower_than(*before, entry, tolerance);
+                // (instruction counts are nearly deterministic, so compare those without allowing for noise)
+                const bool more_instructions = before->instructions > 0 && entry.instructions > 0
+                    && entry.instructions > before->instructions * (1 + tolerance);
+                std::cout << std::setw(14) << before->median_ms << std::setw(11) << limit_ms
+                          << std::setw(8) << std::setprecision(1) << std::showpos
+                          << (entry.median_ms / before->median_ms - 1) * 100 << '%'
+                          << std::noshowpos << std::setprecision(3)
+                          << (slower ? "  REGRESSION (time)" : "")
+                          << (more_instructions ? "  REGRESSION (instructions)" : "")
+                          << (attempts > 1 ? "  (best of " + std::to_string(attempts) + " runs)" : "");
+                all_ok = all_ok && !slower && !more_instructions;
+            }
+        }
+        std::cout << '\n';
+        std::cout.flush();
+    }
+
+    if (record) {
+        if (!write_baseline(baseline_file, measured)) {
+            std::cerr << "can't write baseline " << baseline_file << '\n';
+            return false;
+        }
+        std::cout << "baseline written to " << baseline_file << '\n';
+    }
+    else
+        std::cout << (all_ok ? "no regressions\n" : "\nREGRESSIONS OR WRONG ANSWERS\n");
+    return all_ok;
+}
+
+
+int main(int argc, char * argv[])
+{
+    auto usage = [&] {
+        std::cerr << "usage: " << argv[0] << " [--parallel]\n"
+                  << "       " << argv[0] << " --generate DAY SCALE [SEED]\n"
+                  << "       " << argv[0] << " --sweep [--max-scale N] [--seed N] [DAY...]\n"
+                  << "       " << argv[0] << " --record-baseline [FILE]\n"
+                  << "       " << argv[0] << " --check-baseline [--tolerance PERCENT] [FILE]\n";
+        return EXIT_FAILURE;
+    };
+
+    bool parallel = false;
+    if (argc > 1 && std::string_view(argv[1]) == "--generate") {
+        if (argc < 4 || argc > 5)
+            return usage();
+        const std::string text = generate_input(std::stoi(argv[2]), std::stod(argv[3]), argc == 5 ? std::stoull(argv[4]) : 1);
+        if (text.empty())
+            return usage();
+        std::cout << text;
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && std::string_view(argv[1]) == "--sweep") {
+        double max_scale = 10000;
+        uint64_t seed = 1;
+        std::vector<const day *> days;
+        for (int i = 2; i < argc; ++i) {
+            const std::string_view arg(argv[i]);
+            if (arg == "--max-scale" && i + 1 < argc)
+                max_scale = std::stod(argv[++i]);
+            else if (arg == "--seed" && i + 1 < argc)
+                seed = std::stoull(argv[++i]);
+            else {
+                const auto d = std::ranges::find_if(all_days, [&](const day & d) { return std::stoi(d.name) == std::atoi(argv[i]); });
+                if (d == all_days.end())
+                    return usage();
+                days.push_back(&*d);
+            }
+        }
+        if (days.empty())
+            for (const auto & d : all_days)
+                days.push_back(&d);
+        for (const day * d : days)
+            sweep(*d, max_scale, seed);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && (std::string_view(argv[1]) == "--record-baseline" || std::string_view(argv[1]) == "--check-baseline")) {
+        const bool record = std::string_view(argv[1]) == "--record-baseline";
+        std::string baseline_file = "baseline.txt";
+        double tolerance = 0.20;
+        for (int i = 2; i < argc; ++i) {
+            if (!record && std::string_view(argv[i]) == "--tolerance" && i + 1 < argc)
+                tolerance = std::stod(argv[++i]) / 100;
+            else if (argv[i][0] != '-')
+                baseline_file = argv[i];
+            else
+                return usage();
+        }
+        return check_baseline(baseline_file, record, tolerance) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--parallel")
+            parallel = true;
+        else
+            return usage();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<day_result> results = run_all_days(parallel);
+    const std::chrono::duration<double, std::milli> wall_clock = std::chrono::steady_clock::now() - start;
+
+    // "it's 25 milliseconds to midnight on December 24 so just enough time to solve all 25 puzzles"
+    constexpr double budget_ms = 25.0;
+    constexpr int puzzles_in_budget = 25;
+
+    bool all_ok = true;
+    double total_parse_ms = 0, total_solve_ms = 0;
+    std::cout << std::fixed << std::setprecision(2)
+              << "day            part 1            part 2   parse ms   solve ms   total ms\n";
+    for (unsigned i = 0; i < results.size(); ++i) {
+        const day_result & r = results[i];
+        std::cout << std::setw(3) << all_days[i].name;
+        if (!r.input_ok) {
+            std::cout << "   can't read input" << all_days[i].name << ".txt\n";
+            all_ok = false;
+            continue;
+        }
+        std::cout << std::setw(18) << r.part1 << (r.part1_ok ? ' ' : '!')
+                  << std::setw(17) << r.part2 << (r.part2_ok ? ' ' : '!')
+                  << std::setw(10) << r.parse_ms
+                  << std::setw(11) << r.solve_ms
+                  << std::setw(11) << r.parse_ms + r.solve_ms
+                  << (r.parse_ms + r.solve_ms > budget_ms / puzzles_in_budget ? "  (over budget)" : "")
+                  << '\n';
+        all_ok = all_ok && r.part1_ok && r.part2_ok;
+        total_parse_ms += r.parse_ms;
+        total_solve_ms += r.solve_ms;
+    }
+
+    const double budget_for_these_days = budget_ms * results.size() / puzzles_in_budget;
+    std::cout << "sum" << std::setw(46) << total_parse_ms
+              << std::setw(11) << total_solve_ms
+              << std::setw(11) << total_parse_ms + total_solve_ms << '\n'
+              << "\nwall-clock time for all " << results.size() << " days "
+              << (parallel ? "(parallel)" : "(sequential)") << ": " << wall_clock.count() << " ms\n"
+              << "budget: 25 ms for all " << puzzles_in_budget << " puzzles, so "
+              << budget_for_these_days << " ms for these " << results.size() << "; "
+              << (wall_clock.count() <= budget_for_these_days ? "within budget" : "over budget by ")
+              << std::setprecision(1);
+    if (wall_clock.count() > budget_for_these_days)
+        std::cout << wall_clock.count() / budget_for_these_days << "x";
+    std::cout << '\n';
+
+    if (!all_ok)
+        std::cout << "\nWRONG ANSWERS (marked !)\n";
+    return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
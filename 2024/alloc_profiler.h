@@ -0,0 +1,214 @@
+// optional heap allocation profiler for the 2024 puzzle solutions
+//
+// Compile with -DUSE_ALLOC_PROFILER to replace the global operator new and
+// operator delete with versions that count the allocations made, the bytes
+// allocated and the peak number of bytes live at once; benchmark() then
+// reports these for each solve() call, along with the peak resident set size
+// of the whole process. Include this header in only one translation unit
+// (every program here is a single translation unit).
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+#include <sys/resource.h>
+
+
+struct alloc_counts {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+    int64_t live_bytes = 0;
+    int64_t peak_live_bytes = 0;
+};
+
+
+// the running totals updated by the replacement operator new and delete
+struct alloc_counters {
+    std::atomic<uint64_t> allocations = 0;
+    std::atomic<uint64_t> deallocations = 0;
+    std::atomic<uint64_t> bytes_allocated = 0;
+    std::atomic<int64_t> live_bytes = 0;
+    std::atomic<int64_t> peak_live_bytes = 0;
+
+    void allocated(size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+        const int64_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        int64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+    }
+
+    void deallocated(size_t size)
+    {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    alloc_counts snapshot() const
+    {
+        alloc_counts counts;
+        counts.allocations = allocations.load(std::memory_order_relaxed);
+        counts.deallocations = deallocations.load(std::memory_order_relaxed);
+        counts.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        counts.live_bytes = live_bytes.load(std::memory_order_relaxed);
+        counts.peak_live_bytes = peak_live_bytes.load(std::memory_order_relaxed);
+        return counts;
+    }
+
+    // forget the peak so far; the peak from now on starts at what's live now
+    void reset_peak()
+    {
+        peak_live_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
+
+inline alloc_counters global_alloc_counters;
+
+
+// return the peak resident set size of this process in bytes
+inline uint64_t peak_rss_bytes()
+{
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;         // (bytes on macOS...)
+#else
+    return usage.ru_maxrss * 1024;  // (...but kilobytes on Linux)
+#endif
+}
+
+
+struct alloc_report {
+    bool available = false;
+    unsigned calls = 0;
+    double allocations_per_call = 0;
+    double bytes_per_call = 0;
+    int64_t peak_live_bytes = 0;    // (the most any one call had live at once, over what was live before it)
+    uint64_t peak_rss_bytes = 0;
+};
+
+
+// call solve() the given number of times and return its allocation statistics
+template <typename Solver>
+alloc_report profile_allocations([[maybe_unused]] Solver && solve, [[maybe_unused]] unsigned calls)
+{
+    alloc_report report;
+#ifdef USE_ALLOC_PROFILER
+    alloc_counters & counters = global_alloc_counters;
+    report.available = true;
+    report.calls = calls;
+    uint64_t allocations = 0, bytes = 0;
+    for (unsigned i = 0; i < calls; ++i) {
+        counters.reset_peak();
+        const alloc_counts before = counters.snapshot();
+        solve();
+        const alloc_counts after = counters.snapshot();
+        allocations += after.allocations - before.allocations;
+        bytes += after.bytes_allocated - before.bytes_allocated;
+        report.peak_live_bytes = std::max(report.peak_live_bytes, after.peak_live_bytes - before.live_bytes);
+    }
+    report.allocations_per_call = static_cast<double>(allocations) / calls;
+    report.bytes_per_call = static_cast<double>(bytes) / calls;
+    report.peak_rss_bytes = peak_rss_bytes();
+#endif
+    return report;
+}
+
+
+inline std::ostream & operator<<(std::ostream & os, const alloc_report & report)
+{
+    if (!report.available)
+        return os << "  allocation profiling not enabled";
+    return os << "  heap per call: " << report.allocations_per_call << " allocations, "
+              << std::llround(report.bytes_per_call) << " bytes, peak live " << report.peak_live_bytes
+              << " bytes; process peak RSS " << report.peak_rss_bytes / 1024 << " KiB";
+}
+
+
+
+#ifdef USE_ALLOC_PROFILER
+
+// Each block is preceded by a header that records the size requested, so that
+// operator delete knows how many bytes are being freed. For over-aligned
+// allocations the header is as big as the alignment, so the block stays aligned.
+
+namespace alloc_profiler_detail {
+
+constexpr size_t header_size = alignof(std::max_align_t);
+
+inline void * allocate(size_t size, size_t alignment = header_size)
+{
+    const size_t header = alignment > header_size ? alignment : header_size;
+    void * base = nullptr;
+    if (alignment > header_size) {
+        if (posix_memalign(&base, alignment, header + size) != 0)
+            base = nullptr;
+    }
+    else
+        base = std::malloc(header + size);
+    if (!base)
+        return nullptr;
+    char * block = static_cast<char *>(base) + header;
+    reinterpret_cast<size_t *>(block)[-1] = size;
+    global_alloc_counters.allocated(size);
+    return block;
+}
+
+inline void deallocate(void * p, size_t alignment = header_size)
+{
+    if (!p)
+        return;
+    const size_t header = alignment > header_size ? alignment : header_size;
+    char * block = static_cast<char *>(p);
+    global_alloc_counters.deallocated(reinterpret_cast<size_t *>(block)[-1]);
+    std::free(block - header);
+}
+
+inline void * allocate_or_throw(size_t size, size_t alignment = header_size)
+{
+    for (;;) {
+        if (void * p = allocate(size, alignment))
+            return p;
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace alloc_profiler_detail
+
+void * operator new(size_t size) { return alloc_profiler_detail::allocate_or_throw(size); }
+void * operator new[](size_t size) { return alloc_profiler_detail::allocate_or_throw(size); }
+void * operator new(size_t size, const std::nothrow_t &) noexcept { return alloc_profiler_detail::allocate(size); }
+void * operator new[](size_t size, const std::nothrow_t &) noexcept { return alloc_profiler_detail::allocate(size); }
+void * operator new(size_t size, std::align_val_t a) { return alloc_profiler_detail::allocate_or_throw(size, static_cast<size_t>(a)); }
+void * operator new[](size_t size, std::align_val_t a) { return alloc_profiler_detail::allocate_or_throw(size, static_cast<size_t>(a)); }
+void * operator new(size_t size, std::align_val_t a, const std::nothrow_t &) noexcept { return alloc_profiler_detail::allocate(size, static_cast<size_t>(a)); }
+void * operator new[](size_t size, std::align_val_t a, const std::nothrow_t &) noexcept { return alloc_profiler_detail::allocate(size, static_cast<size_t>(a)); }
+
+void operator delete(void * p) noexcept { alloc_profiler_detail::deallocate(p); }
+void operator delete[](void * p) noexcept { alloc_profiler_detail::deallocate(p); }
+void operator delete(void * p, size_t) noexcept { alloc_profiler_detail::deallocate(p); }
+void operator delete[](void * p, size_t) noexcept { alloc_profiler_detail::deallocate(p); }
+void operator delete(void * p, const std::nothrow_t &) noexcept { alloc_profiler_detail::deallocate(p); }
+void operator delete[](void * p, const std::nothrow_t &) noexcept { alloc_profiler_detail::deallocate(p); }
+void operator delete(void * p, std::align_val_t a) noexcept { alloc_profiler_detail::deallocate(p, static_cast<size_t>(a)); }
+void operator delete[](void * p, std::align_val_t a) noexcept { alloc_profiler_detail::deallocate(p, static_cast<size_t>(a)); }
+void operator delete(void * p, size_t, std::align_val_t a) noexcept { alloc_profiler_detail::deallocate(p, static_cast<size_t>(a)); }
+void operator delete[](void * p, size_t, std::align_val_t a) noexcept { alloc_profiler_detail::deallocate(p, static_cast<size_t>(a)); }
+void operator delete(void * p, std::align_val_t a, const std::nothrow_t &) noexcept { alloc_profiler_detail::deallocate(p, static_cast<size_t>(a)); }
+void operator delete[](void * p, std::align_val_t a, const std::nothrow_t &) noexcept { alloc_profiler_detail::deallocate(p, static_cast<size_t>(a)); }
+
+#endif
@@ -0,0 +1,210 @@
+// timing harness shared by all the 2024 puzzle solutions
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "perf_counters.h"
+#include "alloc_profiler.h"
+
+
+struct benchmark_options {
+    double warmup_ms = 50;          // run the solver for at least this long before timing anything
+    double min_ms = 200;            // sample for at least this long...
+    double max_ms = 3000;           // ...and no longer than this (unless min_samples not yet reached)
+    unsigned min_samples = 5;
+    unsigned max_samples = 100000;
+    double target_relative_error = 0.01; // stop when the standard error of the mean is within 1%
+    bool write_json = true;
+};
+
+struct benchmark_result {
+    std::string name;
+    std::vector<double> samples_ms; // (sorted)
+    double min_ms = 0;
+    double median_ms = 0;
+    double p99_ms = 0;
+    double mean_ms = 0;
+    double stddev_ms = 0;
+    perf_report counters; // (only measured when compiled with USE_PERF_COUNTERS)
+    alloc_report allocations; // (only measured when compiled with USE_ALLOC_PROFILER)
+};
+
+
+// pin the calling thread to the core it is currently running on so that the
+// timings aren't disturbed by the scheduler migrating us mid-measurement
+// (not supported on macOS, where this does nothing; not done in USE_THREADS or
+// USE_STREAMING builds)
+inline void pin_to_current_core()
+{
+#ifdef __linux__
+    const int core = sched_getcpu();
+    if (core < 0)
+        return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+#endif
+}
+
+
+// return the sample at the given percentile of the given sorted samples (nearest-rank method)
+inline double percentile(const std::vector<double> & sorted_samples, double p)
+{
+    if (sorted_samples.empty())
+        return 0;
+    const double rank = std::ceil(p / 100.0 * sorted_samples.size());
+    const size_t index = rank < 1 ? 0 : static_cast<size_t>(rank) - 1;
+    return sorted_samples[std::min(index, sorted_samples.size() - 1)];
+}
+
+
+inline void summarise(benchmark_result & result)
+{
+    auto & samples = result.samples_ms;
+    std::ranges::sort(samples);
+    const double n = samples.size();
+    result.min_ms = samples.front();
+    result.median_ms = percentile(samples, 50);
+    result.p99_ms = percentile(samples, 99);
+    result.mean_ms = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+    double sum_of_squares = 0;
+    for (const double s : samples)
+        sum_of_squares += (s - result.mean_ms) * (s - result.mean_ms);
+    result.stddev_ms = n > 1 ? std::sqrt(sum_of_squares / (n - 1)) : 0;
+}
+
+
+inline void write_json(const benchmark_result & result, const std::string & filename)
+{
+    std::ofstream json(filename);
+    if (!json.is_open())
+        return;
+    json << "{\n"
+         << "  \"name\": \"" << result.name << "\",\n"
+         << "  \"timestamp\": " << std::time(nullptr) << ",\n"
+         << "  \"repetitions\": " << result.samples_ms.size() << ",\n"
+         << "  \"min_ms\": " << result.min_ms << ",\n"
+         << "  \"median_ms\": " << result.median_ms << ",\n"
+         << "  \"p99_ms\": " << result.p99_ms << ",\n"
+         << "  \"mean_ms\": " << result.mean_ms << ",\n"
+         << "  \"stddev_ms\": " << result.stddev_ms;
+    if (result.counters.available) {
+        auto write_counts = [&](const perf_counts & counts) {
+            json << "{";
+            for (int i = 0; i < perf_event_count; ++i)
+                json << (i ? ", " : " ") << "\"" << perf_event_names[i] << "\": " << counts.value[i];
+            json << " }";
+        };
+        json << ",\n  \"counters\": {\n    \"per_call\": ";
+        write_counts(result.counters.per_call);
+        for (const auto & part : result.counters.parts) {
+            json << ",\n    \"" << part.name << "\": ";
+            write_counts(part.counts);
+        }
+        json << "\n  }";
+    }
+    if (result.allocations.available) {
+        const alloc_report & a = result.allocations;
+        json << ",\n  \"allocations\": {"
+             << " \"allocations_per_call\": " << a.allocations_per_call
+             << ", \"bytes_per_call\": " << a.bytes_per_call
+             << ", \"peak_live_bytes\": " << a.peak_live_bytes
+             << ", \"peak_rss_bytes\": " << a.peak_rss_bytes << " }";
+    }
+    json << "\n}\n";
+}
+
+
+// call solve() repeatedly and return statistics on how long each call took;
+// the number of repetitions is chosen here: we keep going until the mean is
+// known to within options.target_relative_error (or we run out of time)
+// if options.write_json, the result is also written to bench<name>.json
+// if compiled with USE_PERF_COUNTERS the hardware counters are also measured
+// if compiled with USE_ALLOC_PROFILER the heap allocations are also counted
+template <typename Solver>
+benchmark_result benchmark(const std::string & name, Solver && solve, const benchmark_options & options = {})
+{
+    using clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    // (builds that start threads inside solve() aren't pinned: every thread
+    // they start would inherit the one core and they'd all take turns on it)
+#if !defined(USE_THREADS) && !defined(USE_STREAMING)
+    pin_to_current_core();
+#endif
+
+    const auto warmup_start = clock::now();
+    do
+        solve();
+    while (milliseconds(clock::now() - warmup_start).count() < options.warmup_ms);
+
+    benchmark_result result;
+    result.name = name;
+    double total_ms = 0;
+    double sum = 0, sum_of_squares = 0;
+    for (;;) {
+        const auto start = clock::now();
+        solve();
+        const double ms = milliseconds(clock::now() - start).count();
+
+        result.samples_ms.push_back(ms);
+        total_ms += ms;
+        sum += ms;
+        sum_of_squares += ms * ms;
+
+        const double n = result.samples_ms.size();
+        if (n < options.min_samples)
+            continue;
+        if (n >= options.max_samples || total_ms >= options.max_ms)
+            break;
+        if (total_ms < options.min_ms)
+            continue;
+        const double mean = sum / n;
+        const double variance = std::max(0.0, (sum_of_squares - n * mean * mean) / (n - 1));
+        if (std::sqrt(variance / n) <= options.target_relative_error * mean)
+            break;
+    }
+
+    summarise(result);
+#ifdef USE_PERF_COUNTERS
+    // (counted separately so that reading the counters doesn't disturb the timings)
+    result.counters = profile_counters(solve, std::min<unsigned>(result.samples_ms.size(), 1000));
+#endif
+#ifdef USE_ALLOC_PROFILER
+    result.allocations = profile_allocations(solve, std::min<unsigned>(result.samples_ms.size(), 100));
+#endif
+    if (options.write_json)
+        write_json(result, "bench" + name + ".json");
+    return result;
+}
+
+
+inline std::ostream & operator<<(std::ostream & os, const benchmark_result & result)
+{
+    os << "(" << result.median_ms << " ms median"
+       << ", min " << result.min_ms
+       << ", p99 " << result.p99_ms
+       << ", stddev " << result.stddev_ms
+       << ", " << result.samples_ms.size() << " runs)";
+#ifdef USE_PERF_COUNTERS
+    os << '\n' << result.counters;
+#endif
+#ifdef USE_ALLOC_PROFILER
+    os << '\n' << result.allocations;
+#endif
+    return os;
+}
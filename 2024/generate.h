@@ -0,0 +1,396 @@
+// synthetic puzzle input generators for the 2024 puzzles
+//
+// generate_input(day, scale, seed) returns a valid puzzle input for the given
+// day in the same format as inputNN.txt, but roughly scale times the size of
+// my real input. The same seed always gives the same input. Used by
+// all --generate and all --sweep.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cmath>
+#include <cstdint>
+
+
+namespace generate_detail {
+
+using rng_type = std::mt19937_64;
+
+// return a uniformly distributed random integer in [low, high]
+inline uint64_t uniform(rng_type & rng, uint64_t low, uint64_t high)
+{
+    return std::uniform_int_distribution<uint64_t>(low, high)(rng);
+}
+
+// return true with the given probability
+inline bool chance(rng_type & rng, double probability)
+{
+    return std::uniform_real_distribution<double>(0, 1)(rng) < probability;
+}
+
+// return the number of things there should be in an input scale times the
+// size of one with the given number of things (at least 1)
+inline uint64_t scaled(double count, double scale)
+{
+    return std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(count * scale)));
+}
+
+
+// two columns of 5-digit location IDs; many of the right IDs are also left IDs
+inline std::string day01(double scale, rng_type & rng)
+{
+    const uint64_t n = scaled(1000, scale);
+    std::vector<uint64_t> left(n);
+    for (auto & id : left)
+        id = uniform(rng, 10000, 99999);
+    std::string text;
+    for (uint64_t i = 0; i < n; ++i) {
+        const uint64_t right = chance(rng, 0.5) ? left[uniform(rng, 0, n - 1)] : uniform(rng, 10000, 99999);
+        text += std::to_string(left[i]) + "   " + std::to_string(right) + '\n';
+    }
+    return text;
+}
+
+
+// reports of 5 to 8 levels that mostly change steadily, some with one or two bad levels
+inline std::string day02(double scale, rng_type & rng)
+{
+    const uint64_t n = scaled(1000, scale);
+    std::string text;
+    for (uint64_t i = 0; i < n; ++i) {
+        const unsigned length = uniform(rng, 5, 8);
+        const int direction = chance(rng, 0.5) ? 1 : -1;
+        int level = direction > 0 ? uniform(rng, 1, 60) : uniform(rng, 40, 99);
+        const unsigned bad_levels = chance(rng, 0.5) ? 0 : uniform(rng, 1, 2);
+        std::vector<unsigned> bad;
+        for (unsigned b = 0; b < bad_levels; ++b)
+            bad.push_back(uniform(rng, 0, length - 1));
+        for (unsigned j = 0; j < length; ++j) {
+            if (j)
+                text += ' ';
+            if (std::ranges::find(bad, j) != bad.end())
+                text += std::to_string(std::max(1, level + static_cast<int>(uniform(rng, 0, 8)) - 4));
+            else
+                text += std::to_string(std::max(1, level));
+            level += direction * static_cast<int>(uniform(rng, 1, 3));
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+
+// corrupted memory: punctuation and junk words, mul(a,b) instructions, some of
+// them corrupted, and do()/don't() instructions
+inline std::string day03(double scale, rng_type & rng)
+{
+    const uint64_t length = scaled(18869, scale);
+    static const char * const junk[] = {
+        "what()", "from()", "who()", "why()", "when()", "how()", "select()", "where()",
+        "mul[", "mul (", "mul(4*", "mul(6,9!", "?(12,34)", "don't", "do(", "mul(1234,5)",
+    };
+    const char punctuation[] = "!@#$%^&*()[]{}<>'+-,;:?/~ ";
+    std::string text;
+    unsigned line_length = 0;
+    while (text.size() < length) {
+        const uint64_t r = uniform(rng, 0, 99);
+        std::string token;
+        if (r < 30)
+            token = "mul(" + std::to_string(uniform(rng, 1, 999)) + "," + std::to_string(uniform(rng, 1, 999)) + ")";
+        else if (r < 33)
+            token = "do()";
+        else if (r < 36)
+            token = "don't()";
+        else if (r < 60)
+            token = junk[uniform(rng, 0, std::size(junk) - 1)];
+        else
+            token = punctuation[uniform(rng, 0, sizeof(punctuation) - 2)];
+        text += token;
+        line_length += token.size();
+        if (line_length > 3000) {
+            text += '\n';
+            line_length = 0;
+        }
+    }
+    text += '\n';
+    return text;
+}
+
+
+// a square grid of the letters X, M, A and S
+inline std::string day04(double scale, rng_type & rng)
+{
+    const uint64_t side = scaled(140, std::sqrt(scale));
+    std::string text;
+    text.reserve(side * (side + 1));
+    for (uint64_t r = 0; r < side; ++r) {
+        for (uint64_t c = 0; c < side; ++c)
+            text += "XMAS"[uniform(rng, 0, 3)];
+        text += '\n';
+    }
+    return text;
+}
+
+
+// page ordering rules for every pair of pages (consistent with one random
+// total order) followed by updates, about half of them correctly ordered
+inline std::string day05(double scale, rng_type & rng)
+{
+    const uint64_t pages = std::max<uint64_t>(5, scaled(49, std::sqrt(scale)));
+    const uint64_t updates = scaled(200, std::sqrt(scale));
+    std::vector<uint64_t> order(pages);
+    std::iota(order.begin(), order.end(), 10);
+    std::ranges::shuffle(order, rng);
+
+    std::string text;
+    for (uint64_t i = 0; i < pages; ++i)
+        for (uint64_t j = i + 1; j < pages; ++j)
+            text += std::to_string(order[i]) + "|" + std::to_string(order[j]) + '\n';
+    text += '\n';
+
+    const uint64_t max_length = std::clamp<uint64_t>(scaled(23, std::sqrt(scale)), 5, pages) | 1;
+    for (uint64_t u = 0; u < updates; ++u) {
+        // (an odd number of pages, so there's a middle one)
+        const uint64_t length = uniform(rng, 2, (max_length - 1) / 2) * 2 + 1;
+        std::vector<uint64_t> indexes(pages);
+        std::iota(indexes.begin(), indexes.end(), 0);
+        std::ranges::shuffle(indexes, rng);
+        indexes.resize(std::min(length, pages));
+        if (chance(rng, 0.5))
+            std::ranges::sort(indexes);
+        for (uint64_t i = 0; i < indexes.size(); ++i)
+            text += (i ? "," : "") + std::to_string(order[indexes[i]]);
+        text += '\n';
+    }
+    return text;
+}
+
+
+// a square map with about 5% obstructions and the guard somewhere facing north;
+// the guard walks off the map (i.e. part 1 has an answer) after covering about
+// 30% of it, as in my input
+//
+// A random map only gives the guard a short walk, so the route is laid out
+// first, one straight run at a time, each ended by an obstruction put just
+// past it (or by one already there). A run may cross the route so far but
+// never go along it in the same direction, or the guard would go round in a
+// loop. Once the route is long enough it runs straight off the map, and the
+// rest of the obstructions are scattered where the guard never goes.
+inline std::string day06(double scale, rng_type & rng)
+{
+    const int side = static_cast<int>(scaled(130, std::sqrt(scale)));
+    const int dr[] = {-1, 0, 1, 0}, dc[] = {0, 1, 0, -1};
+    const uint64_t route_wanted = uint64_t(side) * side * 3 / 10;
+    auto on_map = [side](int r, int c) { return 0 <= r && r < side && 0 <= c && c < side; };
+    for (;;) {
+        std::string map(side * side, '.');
+        std::vector<unsigned char> seen(map.size(), 0); // (bit h set iff the guard is at the cell facing h)
+        const int start = uniform(rng, 0, map.size() - 1);
+        int r = start / side, c = start % side, head = 0;
+        seen[start] = 1;
+        uint64_t route = 1;
+
+        // (the lengths of run the guard could take from here and then turn,
+        // -1 for one ending at an obstruction that's already there)
+        std::vector<int> runs;
+        bool off_map = false;
+        for (;;) {
+            runs.clear();
+            const int next = (head + 1) % 4;
+            int length = 0, to_edge = -1;
+            for (int rr = r, cc = c; ; ++length) {
+                const int nr = rr + dr[head], nc = cc + dc[head];
+                if (!on_map(nr, nc)) {
+                    to_edge = length;
+                    break;
+                }
+                // (after turning at (rr, cc), the guard mustn't be on the
+                // route facing the same way, nor about to step onto it so)
+                const int tr = rr + dr[next], tc = cc + dc[next];
+                const bool can_turn = !(seen[rr * side + cc] & (1 << next))
+                    && !(on_map(tr, tc) && (seen[tr * side + tc] & (1 << next)));
+                if (map[nr * side + nc] == '#') {
+                    if (can_turn)
+                        runs.push_back(-1);
+                    break;
+                }
+                if (can_turn && !seen[nr * side + nc])
+                    runs.push_back(length); // (with an obstruction put at (nr, nc))
+                if (seen[nr * side + nc] & (1 << head))
+                    break;
+                rr = nr, cc = nc;
+            }
+
+            int run = 0;
+            if (route >= route_wanted && to_edge >= 0)
+                off_map = true;
+            else if (runs.empty())
+                break; // (stuck: start again)
+            else // (longer runs are more likely, so the route takes fewer turns)
+                run = runs[std::max(uniform(rng, 0, runs.size() - 1), uniform(rng, 0, runs.size() - 1))];
+
+            const int steps = off_map ? to_edge : run >= 0 ? run : length;
+            for (int i = 0; i < steps; ++i) {
+                r += dr[head], c += dc[head];
+                route += seen[r * side + c] == 0;
+                seen[r * side + c] |= 1 << head;
+            }
+            if (off_map)
+                break;
+            if (run >= 0)
+                map[(r + dr[head]) * side + c + dc[head]] = '#';
+            head = next;
+            seen[r * side + c] |= 1 << head;
+        }
+        if (!off_map)
+            continue;
+
+        for (size_t i = 0; i < map.size(); ++i)
+            if (!seen[i] && map[i] == '.' && chance(rng, 0.049))
+                map[i] = '#';
+        map[start] = '^';
+        std::string text;
+        for (int row = 0; row < side; ++row)
+            text += map.substr(row * side, side) + '\n';
+        return text;
+    }
+}
+
+
+// calibration equations of 2 to 12 terms; the answers of most were made with
+// + and *, some also with ||, and the rest can't be made at all
+inline std::string day07(double scale, rng_type & rng)
+{
+    const uint64_t n = scaled(850, scale);
+    constexpr uint64_t limit = 1'000'000'000'000'000ULL; // (keep the answers well within 64 bits)
+    std::string text;
+    for (uint64_t i = 0; i < n; ++i) {
+        const unsigned length = uniform(rng, 2, 12);
+        const uint64_t kind = uniform(rng, 0, 2); // 0: + and *, 1: + * and ||, 2: unsolvable
+        std::vector<uint64_t> terms;
+        uint64_t answer = 0;
+        for (unsigned t = 0; t < length; ++t) {
+            const uint64_t term = uniform(rng, 1, chance(rng, 0.7) ? 9 : 999);
+            terms.push_back(term);
+            if (t == 0) {
+                answer = term;
+                continue;
+            }
+            uint64_t op = uniform(rng, 0, kind == 1 ? 2 : 1);
+            uint64_t p = 1;
+            while (p <= term)
+                p *= 10;
+            if (op == 1 && answer > limit / term)
+                op = 0;
+            if (op == 2 && answer > limit / p)
+                op = 0;
+            switch (op) {
+            case 0: answer += term;                 break;
+            case 1: answer *= term;                 break;
+            default: answer = answer * p + term;    break;
+            }
+        }
+        if (kind == 2)
+            answer += uniform(rng, 1, 3);   // (almost certainly not makeable any more)
+        text += std::to_string(answer) + ":";
+        for (const auto t : terms)
+            text += " " + std::to_string(t);
+        text += '\n';
+    }
+    return text;
+}
+
+
+// a square map with about 4 antennas per frequency, up to 62 frequencies
+inline std::string day08(double scale, rng_type & rng)
+{
+    const uint64_t side = scaled(50, std::sqrt(scale));
+    const char frequencies[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string map(side * side, '.');
+    const uint64_t antennas = std::min<uint64_t>(map.size() / 4, scaled(200, scale));
+    for (uint64_t a = 0; a < antennas; ++a)
+        map[uniform(rng, 0, map.size() - 1)] = frequencies[uniform(rng, 0, sizeof(frequencies) - 2)];
+    std::string text;
+    for (uint64_t r = 0; r < side; ++r)
+        text += map.substr(r * side, side) + '\n';
+    return text;
+}
+
+
+// a disk map: alternating file lengths (1-9) and free space lengths (0-9)
+inline std::string day09(double scale, rng_type & rng)
+{
+    const uint64_t length = scaled(19999, scale) | 1;
+    std::string text(length, '0');
+    for (uint64_t i = 0; i < length; ++i)
+        text[i] = '0' + uniform(rng, (i & 1) ? 0 : 1, 9);
+    return text + '\n';
+}
+
+
+// a square topographic map of random heights with many hiking trails carved into it
+inline std::string day10(double scale, rng_type & rng)
+{
+    const int side = static_cast<int>(scaled(57, std::sqrt(scale)));
+    std::string map(side * side, '0');
+    for (auto & c : map)
+        c = '0' + uniform(rng, 0, 9);
+    const uint64_t trails = scaled(side * side / 12.0, 1);
+    const int dr[] = {-1, 0, 1, 0}, dc[] = {0, 1, 0, -1};
+    for (uint64_t t = 0; t < trails; ++t) {
+        int r = uniform(rng, 0, side - 1), c = uniform(rng, 0, side - 1);
+        for (char height = '0'; height <= '9'; ++height) {
+            map[r * side + c] = height;
+            const int d = uniform(rng, 0, 3);
+            const int nr = r + dr[d], nc = c + dc[d];
+            if (nr < 0 || nr >= side || nc < 0 || nc >= side)
+                break;
+            r = nr, c = nc;
+        }
+    }
+    std::string text;
+    for (int r = 0; r < side; ++r)
+        text += map.substr(r * side, side) + '\n';
+    return text;
+}
+
+
+// a line of stones with numbers of up to 7 digits
+inline std::string day11(double scale, rng_type & rng)
+{
+    const uint64_t n = scaled(8, scale);
+    std::string text;
+    for (uint64_t i = 0; i < n; ++i)
+        text += (i ? " " : "") + std::to_string(uniform(rng, 0, chance(rng, 0.3) ? 99 : 9999999));
+    return text + '\n';
+}
+
+} // namespace generate_detail
+
+
+
+// return a generated puzzle input for the given day about scale times the size
+// of my real input, or an empty string if there's no generator for the day
+inline std::string generate_input(unsigned day, double scale, uint64_t seed)
+{
+    using namespace generate_detail;
+    rng_type rng(seed);
+    switch (day) {
+    case 1:     return day01(scale, rng);
+    case 2:     return day02(scale, rng);
+    case 3:     return day03(scale, rng);
+    case 4:     return day04(scale, rng);
+    case 5:     return day05(scale, rng);
+    case 6:     return day06(scale, rng);
+    case 7:     return day07(scale, rng);
+    case 8:     return day08(scale, rng);
+    case 9:     return day09(scale, rng);
+    case 10:    return day10(scale, rng);
+    case 11:    return day11(scale, rng);
+    default:    return {};
+    }
+}
@@ -0,0 +1,172 @@
+// zero-copy input loading shared by all the 2024 puzzle solutions
+//
+// The whole input file is mapped into memory and handed out as string_views
+// into the mapping, so nothing is copied until a solution decides to build
+// its own data structure. The mapping must outlive any views taken from it.
+
+#pragma once
+
+#include <string_view>
+#include <iterator>
+#include <charconv>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+class mapped_file {
+public:
+    explicit mapped_file(const char * filename)
+    {
+        const int fd = open(filename, O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat status;
+        if (fstat(fd, &status) == 0) {
+            if (status.st_size == 0)
+                is_open_ = true;
+            else {
+                void * data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    // (we read every input front to back)
+                    madvise(data, status.st_size, MADV_SEQUENTIAL);
+                    data_ = static_cast<const char *>(data);
+                    size_ = status.st_size;
+                    is_open_ = true;
+                }
+            }
+        }
+        close(fd); // (the mapping stays valid after the file is closed)
+    }
+
+    ~mapped_file()
+    {
+        if (data_)
+            munmap(const_cast<char *>(data_), size_);
+    }
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file & operator=(const mapped_file &) = delete;
+
+    bool is_open() const { return is_open_; }
+
+    // return the entire file contents
+    std::string_view text() const { return {data_, size_}; }
+
+private:
+    const char * data_ = nullptr;
+    size_t size_ = 0;
+    bool is_open_ = false;
+};
+
+
+
+// a range over the lines in some text; each line excludes its line terminator
+// e.g. for (std::string_view line : lines(file.text())) ...
+class lines {
+public:
+    explicit lines(std::string_view text)
+        : text_(text)
+    {}
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view *;
+        using reference = const std::string_view &;
+
+        iterator() = default;
+        iterator(std::string_view rest)
+            : rest_(rest)
+        {
+            next();
+        }
+
+        reference operator*() const { return line_; }
+        pointer operator->() const { return &line_; }
+        iterator & operator++() { next(); return *this; }
+        iterator operator++(int) { iterator i = *this; next(); return i; }
+        bool operator==(const iterator & rhs) const { return at_end_ == rhs.at_end_ && (at_end_ || line_.data() == rhs.line_.data()); }
+
+    private:
+        std::string_view rest_;
+        std::string_view line_;
+        bool at_end_ = true;
+
+        void next()
+        {
+            at_end_ = rest_.empty();
+            if (at_end_)
+                return;
+            const size_t eol = rest_.find('\n');
+            line_ = rest_.substr(0, eol);
+            rest_ = eol == std::string_view::npos ? std::string_view{} : rest_.substr(eol + 1);
+            if (!line_.empty() && line_.back() == '\r')
+                line_.remove_suffix(1);
+        }
+    };
+
+    iterator begin() const { return iterator(text_); }
+    iterator end() const { return iterator(); }
+
+private:
+    std::string_view text_;
+};
+
+
+
+// a rectangular grid of characters viewed in place: rows of `columns`
+// characters, each row followed by its line terminator, so the character at
+// (r, c) is text[r * stride + c]
+struct grid_view {
+    std::string_view text;
+    unsigned rows = 0;
+    unsigned columns = 0;
+    unsigned stride = 0; // (columns + length of line terminator)
+
+    char operator()(unsigned r, unsigned c) const { return text[r * stride + c]; }
+};
+
+// return a view of the grid at the start of the given text; the grid ends at
+// the first empty line or at the end of the text
+inline grid_view make_grid(std::string_view text)
+{
+    grid_view grid;
+    const size_t eol = text.find('\n');
+    grid.columns = text.substr(0, eol).size();
+    if (grid.columns > 0 && text[grid.columns - 1] == '\r')
+        --grid.columns;
+    grid.stride = eol == std::string_view::npos ? grid.columns : eol + 1;
+    for (std::string_view line : lines(text)) {
+        if (line.empty())
+            break;
+        ++grid.rows;
+    }
+    grid.text = text.substr(0, grid.rows * grid.stride);
+    return grid;
+}
+
+
+
+// skip any characters that aren't decimal digits then read the unsigned decimal
+// number that follows into value, advancing text past it; return false if
+// there's no number left in text
+template <typename T>
+bool next_number(std::string_view & text, T & value)
+{
+    size_t i = 0;
+    while (i < text.size() && (text[i] < '0' || text[i] > '9'))
+        ++i;
+    if (i == text.size()) {
+        text = {};
+        return false;
+    }
+    const auto [end, ec] = std::from_chars(text.data() + i, text.data() + text.size(), value);
+    text.remove_prefix(end - text.data());
+    return ec == std::errc{};
+}
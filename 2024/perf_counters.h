@@ -0,0 +1,256 @@
+// optional hardware performance counters for the 2024 puzzle solutions
+//
+// Compile with -DUSE_PERF_COUNTERS to have benchmark() also report cycles,
+// instructions, cache, branch and TLB misses for each solve() call. Mark the
+// parts of a solve() with perf_part("part 1") etc. to have the counts broken
+// down by part. Without USE_PERF_COUNTERS perf_part() does nothing.
+//
+// Only Linux perf_event_open() is supported; elsewhere the counters are
+// reported as unavailable.
+
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+#if defined(USE_PERF_COUNTERS) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+enum perf_event_index {
+    perf_cycles,
+    perf_instructions,
+    perf_l1d_misses,
+    perf_llc_misses,
+    perf_branch_misses,
+    perf_dtlb_misses,
+    perf_event_count
+};
+
+constexpr const char * perf_event_names[perf_event_count] = {
+    "cycles",
+    "instructions",
+    "L1d misses",
+    "LLC misses",
+    "branch misses",
+    "dTLB misses",
+};
+
+struct perf_counts {
+    double value[perf_event_count] = {};
+
+    perf_counts & operator+=(const perf_counts & rhs)
+    {
+        for (int i = 0; i < perf_event_count; ++i)
+            value[i] += rhs.value[i];
+        return *this;
+    }
+    friend perf_counts operator-(perf_counts lhs, const perf_counts & rhs)
+    {
+        for (int i = 0; i < perf_event_count; ++i)
+            lhs.value[i] -= rhs.value[i];
+        return lhs;
+    }
+    friend perf_counts operator/(perf_counts lhs, double divisor)
+    {
+        for (int i = 0; i < perf_event_count; ++i)
+            lhs.value[i] /= divisor;
+        return lhs;
+    }
+};
+
+
+// one counter per perf_event_index, counting user-space events in the calling thread
+class perf_counters {
+public:
+    perf_counters()
+    {
+#if defined(USE_PERF_COUNTERS) && defined(__linux__)
+        auto cache_event = [](uint64_t cache, uint64_t result) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+        };
+        const std::pair<uint32_t, uint64_t> events[perf_event_count] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        };
+        for (int i = 0; i < perf_event_count; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // there are usually fewer hardware counters than events, so the
+            // kernel may multiplex them; we scale the counts by these times
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd_[i] < 0 && error_.empty())
+                error_ = std::string(perf_event_names[i]) + ": " + std::strerror(errno);
+        }
+#else
+        error_ = "not supported in this build";
+#endif
+    }
+
+    ~perf_counters()
+    {
+#if defined(USE_PERF_COUNTERS) && defined(__linux__)
+        for (const int fd : fd_)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    perf_counters(const perf_counters &) = delete;
+    perf_counters & operator=(const perf_counters &) = delete;
+
+    // return true iff at least one of the counters could be opened
+    bool available() const
+    {
+        for (const int fd : fd_)
+            if (fd >= 0)
+                return true;
+        return false;
+    }
+
+    // return a description of why the first unavailable counter couldn't be opened
+    const std::string & error() const { return error_; }
+
+    // return the current (scaled) value of each counter since it was opened
+    perf_counts read() const
+    {
+        perf_counts counts;
+#if defined(USE_PERF_COUNTERS) && defined(__linux__)
+        for (int i = 0; i < perf_event_count; ++i) {
+            uint64_t data[3]; // value, time enabled, time running
+            if (fd_[i] < 0 || ::read(fd_[i], data, sizeof(data)) != sizeof(data))
+                continue;
+            counts.value[i] = data[2] ? data[0] * (static_cast<double>(data[1]) / data[2]) : 0;
+        }
+#endif
+        return counts;
+    }
+
+private:
+    int fd_[perf_event_count] = {-1, -1, -1, -1, -1, -1};
+    std::string error_;
+};
+
+
+struct perf_part_counts {
+    std::string name;
+    perf_counts counts; // (total over all calls)
+};
+
+struct perf_report {
+    bool available = false;
+    std::string error;
+    unsigned calls = 0;
+    perf_counts per_call;
+    std::vector<perf_part_counts> parts; // (averaged per call)
+};
+
+
+// the state shared between profile_counters() and perf_part()
+struct perf_recorder {
+    const perf_counters * counters = nullptr; // (null when not recording)
+    const char * current_part = nullptr;
+    perf_counts part_start;
+    std::vector<perf_part_counts> parts;
+};
+
+inline thread_local perf_recorder perf_recorder_instance;
+
+
+// mark the start of the named part of a solve(); the previous part, if any, ends here
+inline void perf_part([[maybe_unused]] const char * name)
+{
+#ifdef USE_PERF_COUNTERS
+    perf_recorder & recorder = perf_recorder_instance;
+    if (!recorder.counters)
+        return;
+    const perf_counts now = recorder.counters->read();
+    if (recorder.current_part) {
+        auto part = recorder.parts.begin();
+        while (part != recorder.parts.end() && part->name != recorder.current_part)
+            ++part;
+        if (part == recorder.parts.end())
+            part = recorder.parts.insert(part, {recorder.current_part, {}});
+        part->counts += now - recorder.part_start;
+    }
+    recorder.current_part = name;
+    recorder.part_start = now;
+#endif
+}
+
+
+// call solve() the given number of times and return its average counter values
+template <typename Solver>
+perf_report profile_counters(Solver && solve, unsigned calls)
+{
+    perf_report report;
+    const perf_counters counters;
+    if (!counters.available()) {
+        report.error = counters.error();
+        return report;
+    }
+
+    perf_recorder & recorder = perf_recorder_instance;
+    recorder = perf_recorder{};
+    recorder.counters = &counters;
+    const perf_counts start = counters.read();
+    for (unsigned i = 0; i < calls; ++i) {
+        solve();
+        perf_part(nullptr);
+    }
+    const perf_counts end = counters.read();
+    recorder.counters = nullptr;
+
+    report.available = true;
+    report.calls = calls;
+    report.per_call = (end - start) / calls;
+    for (const auto & part : recorder.parts)
+        report.parts.push_back({part.name, part.counts / calls});
+    return report;
+}
+
+
+inline std::ostream & operator<<(std::ostream & os, const perf_counts & counts)
+{
+    const auto flags = os.flags();
+    os << std::fixed << std::setprecision(0);
+    for (int i = 0; i < perf_event_count; ++i) {
+        if (i)
+            os << ", ";
+        os << counts.value[i] << ' ' << perf_event_names[i];
+        if (i == perf_instructions && counts.value[perf_cycles] > 0)
+            os << std::setprecision(2) << " (" << counts.value[perf_instructions] / counts.value[perf_cycles]
+               << " IPC)" << std::setprecision(0);
+    }
+    os.flags(flags);
+    return os;
+}
+
+inline std::ostream & operator<<(std::ostream & os, const perf_report & report)
+{
+    if (!report.available)
+        return os << "  perf counters unavailable (" << report.error << ")";
+    os << "  per call: " << report.per_call;
+    for (const auto & part : report.parts)
+        os << "\n  " << part.name << ": " << part.counts;
+    return os;
+}
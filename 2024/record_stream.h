@@ -0,0 +1,115 @@
+// pipelined reading of line-per-record puzzle inputs
+//
+// stream_records() parses the records on a reader thread, a chunk of records
+// at a time, and hands each chunk over through a bounded queue to the calling
+// thread, which works on the records while the reader gets on with the next
+// chunk. Parsing and solving overlap, the first results are available long
+// before the whole input has been read, and memory use is bounded by the size
+// of the queue however big the input is.
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+#include "mapped_file.h"
+
+
+// a queue of chunks of records passed from one producer to one consumer;
+// push() waits while the queue is full
+template <typename Record>
+class chunk_queue {
+public:
+    explicit chunk_queue(size_t max_chunks)
+        : max_chunks_(max_chunks)
+    {}
+
+    void push(std::vector<Record> && chunk)
+    {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [&] { return chunks_.size() < max_chunks_; });
+        chunks_.push_back(std::move(chunk));
+        not_empty_.notify_one();
+    }
+
+    // wait for the next chunk; return false if there are no more
+    bool pop(std::vector<Record> & chunk)
+    {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [&] { return !chunks_.empty() || closed_; });
+        if (chunks_.empty())
+            return false;
+        chunk = std::move(chunks_.front());
+        chunks_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // no more chunks will be pushed
+    void close()
+    {
+        std::lock_guard lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<std::vector<Record>> chunks_;
+    const size_t max_chunks_;
+    bool closed_ = false;
+};
+
+
+// call parse_record(line, record) for each non-empty line of text on a reader
+// thread, and consume(record) for each record so parsed on the calling thread,
+// in order; the reader gets at most max_chunks chunks of chunk_size records
+// ahead of the consumer; return false if parse_record() returned false for
+// any line (in which case reading stops there and not every record before it
+// may have been consumed)
+template <typename Record, typename Parse, typename Consume>
+bool stream_records(std::string_view text, Parse parse_record, Consume consume,
+    size_t chunk_size = 1024, size_t max_chunks = 8)
+{
+    chunk_queue<Record> queue(max_chunks);
+    std::atomic<bool> ok = true;
+
+    std::thread reader([&] {
+        std::vector<Record> chunk;
+        chunk.reserve(chunk_size);
+        for (const std::string_view line : lines(text)) {
+            if (line.empty())
+                continue;
+            Record record{};
+            if (!parse_record(line, record)) {
+                ok = false;
+                break;
+            }
+            chunk.push_back(std::move(record));
+            if (chunk.size() == chunk_size) {
+                queue.push(std::move(chunk));
+                chunk = {};
+                chunk.reserve(chunk_size);
+            }
+        }
+        if (!chunk.empty())
+            queue.push(std::move(chunk));
+        queue.close();
+    });
+
+    std::vector<Record> chunk;
+    while (queue.pop(chunk))
+        for (const Record & record : chunk)
+            consume(record);
+
+    reader.join();
+    return ok;
+}
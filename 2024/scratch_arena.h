@@ -0,0 +1,111 @@
+// scratch memory for the temporary containers built inside solve()
+//
+// A scratch_arena is a std::pmr::monotonic_buffer_resource that starts out
+// with a buffer kept by the calling thread from one solve() call to the next.
+// Allocations just bump a pointer and deallocations do nothing; all the
+// memory is given back at once when the arena is destroyed at the end of the
+// call. If a call needs more than the buffer holds, the rest comes from the
+// global heap and the buffer is grown to the high-water mark afterwards, so
+// after the first call or two a solve() that makes its containers from the
+// arena doesn't touch the global heap at all.
+//
+// e.g.
+//     scratch_arena arena;
+//     std::pmr::unordered_set<int> seen(&arena);
+
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <cstddef>
+
+
+namespace scratch_arena_detail {
+
+// the buffer the calling thread's arenas start from
+struct scratch_buffer {
+    std::unique_ptr<std::byte[]> data;
+    size_t size = 0;
+    bool in_use = false;    // (an arena nested inside another doesn't get the buffer)
+};
+
+inline thread_local scratch_buffer thread_buffer;
+
+
+// a memory_resource that passes everything on to the global heap and keeps
+// count of how many bytes it was asked for
+class counting_resource : public std::pmr::memory_resource {
+public:
+    size_t bytes_allocated = 0;
+
+private:
+    void * do_allocate(size_t bytes, size_t alignment) override
+    {
+        bytes_allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void * p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace scratch_arena_detail
+
+
+
+class scratch_arena : public std::pmr::memory_resource {
+public:
+    scratch_arena()
+        : owns_buffer_(!scratch_arena_detail::thread_buffer.in_use),
+          arena_(owns_buffer_ ? scratch_arena_detail::thread_buffer.data.get() : nullptr,
+                 owns_buffer_ ? scratch_arena_detail::thread_buffer.size : 0,
+                 &overflow_)
+    {
+        if (owns_buffer_)
+            scratch_arena_detail::thread_buffer.in_use = true;
+    }
+
+    ~scratch_arena()
+    {
+        arena_.release();
+        if (!owns_buffer_)
+            return;
+        auto & buffer = scratch_arena_detail::thread_buffer;
+        if (overflow_.bytes_allocated > 0) {
+            // make the buffer big enough to hold everything this call needed
+            buffer.size += overflow_.bytes_allocated;
+            buffer.data = std::make_unique_for_overwrite<std::byte[]>(buffer.size);
+        }
+        buffer.in_use = false;
+    }
+
+    scratch_arena(const scratch_arena &) = delete;
+    scratch_arena & operator=(const scratch_arena &) = delete;
+
+private:
+    bool owns_buffer_;
+    scratch_arena_detail::counting_resource overflow_;
+    std::pmr::monotonic_buffer_resource arena_;
+
+    void * do_allocate(size_t bytes, size_t alignment) override
+    {
+        return arena_.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *, size_t, size_t) override
+    {
+        // (memory is only given back when the arena is destroyed)
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+};
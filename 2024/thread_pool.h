@@ -0,0 +1,120 @@
+// a pool of worker threads shared by the solutions that split their work up
+//
+// The threads are started once and wait between jobs, so a solve() that's
+// called thousands of times by benchmark() doesn't start and stop threads
+// on every call.
+//
+// e.g.
+//     shared_thread_pool().for_each(chunks, [&](unsigned chunk) { ... });
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+
+class thread_pool {
+public:
+    // start threads - 1 workers (the thread that calls for_each() is the other one)
+    explicit thread_pool(unsigned threads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (unsigned i = 1; i < threads; ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        job_ready_.notify_all();
+        for (auto & worker : workers_)
+            worker.join();
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool & operator=(const thread_pool &) = delete;
+
+    // the number of threads that share the work, including the caller
+    unsigned size() const { return workers_.size() + 1; }
+
+    // call task(i) for each i in [0, count), spread over the workers and the
+    // calling thread; return when they've all finished (one job at a time:
+    // for_each() must not be called from inside a task)
+    template <typename Task>
+    void for_each(unsigned count, Task && task)
+    {
+        if (count == 0)
+            return;
+        if (workers_.empty() || count == 1) {
+            for (unsigned i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            task_ = std::ref(task);
+            task_count_ = count;
+            next_task_ = 0;
+            busy_workers_ = workers_.size();
+            ++job_;
+        }
+        job_ready_.notify_all();
+        run_tasks();
+        std::unique_lock lock(mutex_);
+        job_done_.wait(lock, [&] { return busy_workers_ == 0; });
+        task_ = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable job_done_;
+    std::function<void(unsigned)> task_;
+    unsigned task_count_ = 0;
+    std::atomic<unsigned> next_task_ = 0;
+    unsigned busy_workers_ = 0;
+    uint64_t job_ = 0;
+    bool stopping_ = false;
+
+    // take tasks from the current job until there are none left
+    void run_tasks()
+    {
+        for (unsigned i; (i = next_task_++) < task_count_; )
+            task_(i);
+    }
+
+    void work()
+    {
+        uint64_t jobs_seen = 0;
+        for (;;) {
+            {
+                std::unique_lock lock(mutex_);
+                job_ready_.wait(lock, [&] { return stopping_ || job_ != jobs_seen; });
+                if (stopping_)
+                    return;
+                jobs_seen = job_;
+            }
+            run_tasks();
+            std::lock_guard lock(mutex_);
+            if (--busy_workers_ == 0)
+                job_done_.notify_one();
+        }
+    }
+};
+
+
+// return the pool used by every solution
+inline thread_pool & shared_thread_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
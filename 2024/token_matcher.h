@@ -0,0 +1,337 @@
+// token matchers compiled from a pattern at compile time
+//
+// token_matcher<"do()|don't()|mul(\\d{1,3},\\d{1,3})"> parses its pattern
+// when the program is compiled and expands into a matcher for exactly that
+// pattern: every literal, digit run and alternative is a separate inline
+// test with its characters and limits as constants, so there's nothing to
+// interpret at run time, unlike std::regex.
+//
+// The pattern grammar is
+//     pattern     := alternative ( '|' alternative )*
+//     alternative := element+     (starting with a literal)
+//     element     := '\d' | '\d{N}' | '\d{MIN,MAX}'   (a run of decimal digits)
+//                  | '\' any character                (that character)
+//                  | any other character              (itself)
+// A digit run is read greedily, without backtracking, and its value is
+// captured: numbers[i] is the value of the ith digit run in the alternative
+// that matched. The alternatives are tried in order and the first to match
+// wins.
+//
+// e.g.
+//     using instruction = token_matcher<"mul(\\d{1,3},\\d{1,3})">;
+//     instruction::for_each_token(text.data(), text.data() + text.size(),
+//         text.data() + text.size(), [&](const instruction::match & m) { ... });
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+// a string literal usable as a template argument
+template <size_t N>
+struct fixed_string {
+    char chars[N] {};
+
+    constexpr fixed_string(const char (&s)[N]) { std::copy_n(s, N, chars); }
+    constexpr size_t size() const { return N - 1; }
+    constexpr char operator[](size_t i) const { return chars[i]; }
+};
+
+
+namespace token_matcher_detail {
+
+// one element of an alternative: a literal character, or a run of digits if
+// literal is 0
+struct element {
+    char literal = 0;
+    unsigned min_digits = 0;
+    unsigned max_digits = 0;
+    unsigned number = 0;    // (which of numbers[] the digit run is captured in)
+};
+
+// a pattern parsed into its alternatives; alternative a is elements
+// [alternative_start(a), alternative_ends[a]) (a pattern of N - 1 characters
+// has at most N - 1 elements and N / 2 alternatives)
+template <size_t N>
+struct parsed_pattern {
+    element elements[N] {};
+    size_t alternative_ends[N] {};
+    size_t alternatives = 0;
+    unsigned max_numbers = 0;
+    size_t max_length = 0;  // (the most characters any token can have)
+
+    constexpr size_t alternative_start(size_t a) const { return a == 0 ? 0 : alternative_ends[a - 1]; }
+};
+
+// parse the given pattern; a pattern that doesn't follow the grammar is a
+// compile error (the throw isn't a constant expression)
+template <size_t N>
+constexpr parsed_pattern<N> parse(const fixed_string<N> & pattern)
+{
+    parsed_pattern<N> parsed;
+    size_t count = 0;
+    unsigned numbers = 0;
+
+    auto end_alternative = [&] {
+        if (count == parsed.alternative_start(parsed.alternatives))
+            throw "token_matcher: empty alternative";
+        if (parsed.elements[parsed.alternative_start(parsed.alternatives)].literal == 0)
+            throw "token_matcher: an alternative must start with a literal";
+        size_t length = 0;
+        for (size_t i = parsed.alternative_start(parsed.alternatives); i < count; ++i)
+            length += parsed.elements[i].literal ? 1 : parsed.elements[i].max_digits;
+        parsed.max_length = std::max(parsed.max_length, length);
+        parsed.alternative_ends[parsed.alternatives++] = count;
+        parsed.max_numbers = std::max(parsed.max_numbers, numbers);
+        numbers = 0;
+    };
+    auto read_count = [&](size_t & i) {
+        if (i == pattern.size() || pattern[i] < '0' || pattern[i] > '9')
+            throw "token_matcher: expected a digit count";
+        unsigned n = 0;
+        for (; i < pattern.size() && '0' <= pattern[i] && pattern[i] <= '9'; ++i)
+            n = n * 10 + (pattern[i] - '0');
+        return n;
+    };
+
+    for (size_t i = 0; i < pattern.size(); ) {
+        element e;
+        if (pattern[i] == '|') {
+            end_alternative();
+            ++i;
+            continue;
+        }
+        if (pattern[i] != '\\') {
+            e.literal = pattern[i++];
+        }
+        else if (i + 1 == pattern.size())
+            throw "token_matcher: pattern ends with '\\'";
+        else if (pattern[i + 1] != 'd') {
+            e.literal = pattern[i + 1];
+            i += 2;
+        }
+        else {
+            i += 2;
+            e.min_digits = e.max_digits = 1;
+            if (i < pattern.size() && pattern[i] == '{') {
+                ++i;
+                e.min_digits = e.max_digits = read_count(i);
+                if (i < pattern.size() && pattern[i] == ',') {
+                    ++i;
+                    e.max_digits = read_count(i);
+                }
+                if (i == pattern.size() || pattern[i] != '}')
+                    throw "token_matcher: expected '}'";
+                ++i;
+            }
+            if (e.min_digits == 0 || e.max_digits < e.min_digits || e.max_digits > 9)
+                throw "token_matcher: digit runs must be 1 to 9 digits";
+            e.number = numbers++;
+        }
+        parsed.elements[count++] = e;
+    }
+    end_alternative();
+    return parsed;
+}
+
+// return true iff no byte that can start a token can appear in a token
+// anywhere but at its start (a digit run counts as every digit)
+template <size_t N>
+constexpr bool starts_only_at_start(const parsed_pattern<N> & parsed)
+{
+    auto can_start = [&](char c) {
+        for (size_t a = 0; a < parsed.alternatives; ++a)
+            if (parsed.elements[parsed.alternative_start(a)].literal == c)
+                return true;
+        return false;
+    };
+    for (size_t a = 0; a < parsed.alternatives; ++a)
+        for (size_t i = parsed.alternative_start(a) + 1; i < parsed.alternative_ends[a]; ++i) {
+            const element & e = parsed.elements[i];
+            if (e.literal != 0 && can_start(e.literal))
+                return false;
+            if (e.literal == 0)
+                for (char digit = '0'; digit <= '9'; ++digit)
+                    if (can_start(digit))
+                        return false;
+        }
+    return true;
+}
+
+} // namespace token_matcher_detail
+
+
+
+template <fixed_string Pattern>
+class token_matcher {
+public:
+    // the pattern, parsed into its alternatives
+    static constexpr auto parsed = token_matcher_detail::parse(Pattern);
+
+    static constexpr size_t alternatives = parsed.alternatives;
+    static constexpr unsigned max_numbers = parsed.max_numbers;
+
+    // true iff a byte that can start a token is never inside one, so a scan
+    // started anywhere in the text finds the same tokens from its first start
+    // byte on as a scan from the start of the text would
+    static constexpr bool starts_only_at_start = token_matcher_detail::starts_only_at_start(parsed);
+
+    struct match {
+        int alternative = -1;   // (the index of the alternative that matched, or -1 if none did)
+        const char * end = nullptr;
+        unsigned numbers[max_numbers > 0 ? max_numbers : 1];
+
+        explicit operator bool() const { return alternative >= 0; }
+    };
+
+    // return the token at c, which may run on up to c_end, if there is one
+    static match match_at(const char * c, const char * const c_end)
+    {
+        match m;
+        // (if the longest token would fit, there's no need to look for c_end)
+        if (c_end - c >= static_cast<ptrdiff_t>(parsed.max_length))
+            match_any<false>(std::make_index_sequence<alternatives>(), c, c_end, m);
+        else
+            match_any<true>(std::make_index_sequence<alternatives>(), c, c_end, m);
+        return m;
+    }
+
+    // call visit(match) for each token that starts in [first, last), in order,
+    // continuing the search after the end of each token found; tokens may run
+    // on past last, up to c_end
+    //
+    // Only the bytes that can start a token are tried, and these are found
+    // 32 (AVX2) or 16 (SSE2) bytes at a time.
+    template <typename Visit>
+    static void for_each_token(const char * first, const char * const last, const char * const c_end, Visit visit)
+    {
+        const char * next = first;
+        for_each_start_byte(first, last, [&](const char * c) {
+            if (c < next)
+                return; // (inside the last token found)
+            const match m = match_at(c, c_end);
+            if (m) {
+                next = m.end;
+                visit(m);
+            }
+        });
+    }
+
+private:
+    // the distinct first characters of the alternatives
+    struct start_bytes {
+        char bytes[alternatives] {};
+        size_t count = 0;
+    };
+    static constexpr start_bytes starts = [] {
+        start_bytes s;
+        for (size_t a = 0; a < alternatives; ++a) {
+            const char b = parsed.elements[parsed.alternative_start(a)].literal;
+            if (std::find(s.bytes, s.bytes + s.count, b) == s.bytes + s.count)
+                s.bytes[s.count++] = b;
+        }
+        return s;
+    }();
+
+    static bool is_start_byte(char c)
+    {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return ((c == starts.bytes[I]) || ...);
+        }(std::make_index_sequence<starts.count>());
+    }
+
+#if defined(__AVX2__)
+    static constexpr ptrdiff_t block_size = 32;
+#elif defined(__SSE2__)
+    static constexpr ptrdiff_t block_size = 16;
+#else
+    static constexpr ptrdiff_t block_size = 32;
+#endif
+
+    // return a mask with bit i set iff c[i] could start a token, for i < n
+    static uint32_t start_byte_mask(const char * c, ptrdiff_t n)
+    {
+#if defined(__AVX2__)
+        if (n == block_size) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c));
+            return _mm256_movemask_epi8([&]<size_t... I>(std::index_sequence<I...>) {
+                __m256i any = _mm256_setzero_si256();
+                ((any = _mm256_or_si256(any, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(starts.bytes[I])))), ...);
+                return any;
+            }(std::make_index_sequence<starts.count>()));
+        }
+#elif defined(__SSE2__)
+        if (n == block_size) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c));
+            return _mm_movemask_epi8([&]<size_t... I>(std::index_sequence<I...>) {
+                __m128i any = _mm_setzero_si128();
+                ((any = _mm_or_si128(any, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(starts.bytes[I])))), ...);
+                return any;
+            }(std::make_index_sequence<starts.count>()));
+        }
+#endif
+        uint32_t mask = 0;
+        for (ptrdiff_t i = 0; i < n; ++i)
+            mask |= uint32_t(is_start_byte(c[i])) << i;
+        return mask;
+    }
+
+    // call visit(c) for every c in [c, last) that could start a token, finding
+    // them a block at a time (there's just the one call to visit(), so it's
+    // inlined)
+    template <typename Visit>
+    static void for_each_start_byte(const char * c, const char * const last, Visit visit)
+    {
+        for (; c < last; c += block_size)
+            for (uint32_t found = start_byte_mask(c, std::min(block_size, last - c)); found; found &= found - 1)
+                visit(c + std::countr_zero(found));
+    }
+
+    // try each alternative in turn until one matches
+    // (with check_end false, the caller has made sure c_end is far enough off
+    // not to matter)
+    template <bool check_end, size_t... A>
+    static void match_any(std::index_sequence<A...>, const char * c, const char * const c_end, match & m)
+    {
+        (match_alternative<check_end, A>(std::make_index_sequence<parsed.alternative_ends[A] - parsed.alternative_start(A)>(), c, c_end, m) || ...);
+    }
+
+    template <bool check_end, size_t A, size_t... I>
+    static bool match_alternative(std::index_sequence<I...>, const char * c, const char * const c_end, match & m)
+    {
+        if (!(match_element<check_end, parsed.elements[parsed.alternative_start(A) + I]>(c, c_end, m.numbers) && ...))
+            return false;
+        m.alternative = A;
+        m.end = c;
+        return true;
+    }
+
+    template <bool check_end, token_matcher_detail::element E>
+    static bool match_element(const char * & c, const char * const c_end, unsigned * numbers)
+    {
+        if constexpr (E.literal != 0) {
+            if ((check_end && c == c_end) || *c != E.literal)
+                return false;
+            ++c;
+            return true;
+        }
+        else {
+            const char * const first = c;
+            unsigned value = 0;
+            for (unsigned digit; (!check_end || c != c_end) && unsigned(c - first) < E.max_digits && (digit = unsigned(*c - '0')) < 10; ++c)
+                value = value * 10 + digit;
+            if (unsigned(c - first) < E.min_digits)
+                return false;
+            numbers[E.number] = value;
+            return true;
+        }
+    }
+};
@@ -0,0 +1,163 @@
+// vectorized tokenizer for inputs that are mostly unsigned decimal numbers
+//
+// tokenize_numbers() finds the runs of digits in 32 (AVX2) or 16 (SSE2)
+// bytes of text at a time, turning each block into a bitmask of digit
+// positions; the start and end of every number then fall out of the mask
+// with a couple of shifts, so the text is never examined byte by byte. Runs
+// of up to 16 digits are converted to integers with SSE4.1 multiply-adds
+// (build with -march=native, or at least -msse4.1, to get these). On other
+// targets the same code runs with scalar masks and conversion.
+
+#pragma once
+
+#include <vector>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+namespace tokenizer_detail {
+
+#if defined(__AVX2__)
+constexpr unsigned block_size = 32;
+#elif defined(__SSE2__)
+constexpr unsigned block_size = 16;
+#else
+constexpr unsigned block_size = 32;
+#endif
+
+using block_mask = uint32_t;
+constexpr block_mask block_bits = block_size == 32 ? ~block_mask(0) : (block_mask(1) << block_size) - 1;
+
+
+// set bit i of digits iff p[i] is a decimal digit and bit i of newlines iff p[i] is '\n'
+inline void classify_block(const char * p, block_mask & digits, block_mask & newlines)
+{
+#if defined(__AVX2__)
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    const __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+    // (c - '0') as an unsigned byte is <= 9 iff c is a digit
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(9)), offset);
+    digits = static_cast<block_mask>(_mm256_movemask_epi8(is_digit));
+    newlines = static_cast<block_mask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))));
+#elif defined(__SSE2__)
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(9)), offset);
+    digits = static_cast<block_mask>(_mm_movemask_epi8(is_digit));
+    newlines = static_cast<block_mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))));
+#else
+    digits = newlines = 0;
+    for (unsigned i = 0; i < block_size; ++i) {
+        digits |= static_cast<block_mask>(static_cast<unsigned char>(p[i] - '0') <= 9) << i;
+        newlines |= static_cast<block_mask>(p[i] == '\n') << i;
+    }
+#endif
+}
+
+
+// return the value of the given 1 to 20 decimal digits
+inline uint64_t scalar_digits_to_integer(const char * first, const char * last)
+{
+    uint64_t value = 0;
+    for (; first != last; ++first)
+        value = value * 10 + (*first - '0');
+    return value;
+}
+
+// return the value of the decimal digits [first, last); text_begin is the start
+// of the text that contains them, which is needed so that we know how far back
+// it's safe to read
+inline uint64_t digits_to_integer(const char * text_begin, const char * first, const char * last)
+{
+#if defined(__SSE4_1__)
+    const long length = last - first;
+    if (length <= 16 && last - text_begin >= 16) {
+        // load the 16 bytes that end with the last digit and zero everything before the first
+        static const char mask_source[32] = {
+             0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        };
+        const __m128i keep = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask_source + length));
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(last - 16));
+        v = _mm_and_si128(_mm_sub_epi8(v, _mm_set1_epi8('0')), keep);
+        // combine pairs of digits, then pairs of pairs, and so on
+        v = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        v = _mm_madd_epi16(v, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+        v = _mm_packus_epi32(v, v);
+        v = _mm_madd_epi16(v, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+        const uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+        const uint64_t low = static_cast<uint32_t>(_mm_extract_epi32(v, 1));
+        return high * 100000000ULL + low;
+    }
+#endif
+    (void)text_begin;
+    return scalar_digits_to_integer(first, last);
+}
+
+} // namespace tokenizer_detail
+
+
+
+// append every unsigned decimal number in text to numbers, in order; anything
+// that isn't a digit is a separator
+// if line_ends is not null, append numbers.size() to it at the end of each
+// line, so that the numbers on line i are those in [line_ends[i-1], line_ends[i])
+template <typename T>
+void tokenize_numbers(std::string_view text, std::vector<T> & numbers, std::vector<uint32_t> * line_ends = nullptr)
+{
+    using namespace tokenizer_detail;
+
+    const char * const begin = text.data();
+    const char * const end = begin + text.size();
+    const char * number_start = nullptr;    // (non-null while inside a run of digits)
+    block_mask previous_digit = 0;          // (1 iff the last byte of the previous block was a digit)
+
+    auto process = [&](const char * block, block_mask digits, block_mask newlines) {
+        const block_mask shifted = (digits << 1) | previous_digit;
+        block_mask events = ((digits & ~shifted) | (~digits & shifted) | newlines) & block_bits;
+        while (events) {
+            const unsigned i = std::countr_zero(events);
+            events &= events - 1;
+            const block_mask bit = block_mask(1) << i;
+            if (digits & bit)
+                number_start = block + i;
+            else {
+                if (number_start) {
+                    numbers.push_back(static_cast<T>(digits_to_integer(begin, number_start, block + i)));
+                    number_start = nullptr;
+                }
+                if ((newlines & bit) && line_ends)
+                    line_ends->push_back(static_cast<uint32_t>(numbers.size()));
+            }
+        }
+        previous_digit = digits >> (block_size - 1);
+    };
+
+    const char * p = begin;
+    for (; end - p >= block_size; p += block_size) {
+        block_mask digits, newlines;
+        classify_block(p, digits, newlines);
+        process(p, digits, newlines);
+    }
+    if (p != end) {
+        // copy the tail into a padded block so we never read past the end of the text
+        char tail[block_size];
+        std::memset(tail, ' ', block_size);
+        std::memcpy(tail, p, end - p);
+        block_mask digits, newlines;
+        classify_block(tail, digits, newlines);
+        // (a number running up to the end of the text ends at the first space of
+        // padding, i.e. at end, so it is converted from the text, not the copy)
+        process(p, digits, newlines);
+    }
+    if (number_start)
+        numbers.push_back(static_cast<T>(digits_to_integer(begin, number_start, end)));
+    if (line_ends && !text.empty() && text.back() != '\n')
+        line_ends->push_back(static_cast<uint32_t>(numbers.size()));
+}
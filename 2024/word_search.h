@@ -0,0 +1,147 @@
+// word search over a grid of letters for any number of words at once
+//
+// word_search builds an Aho-Corasick automaton from the words and their
+// reverses, so running it forwards along a line finds the words going both
+// ways along it. count() makes one pass over the grid, row by row, stepping
+// four automata at each cell: one along the row and one down each of the
+// column, the diagonal and the anti-diagonal through the cell (each kept
+// from the row above). That finds every word in all eight directions with
+// four table lookups per cell, however many words there are.
+//
+// e.g.
+//     const word_search search({"XMAS"});
+//     const uint64_t xmases = search.count(grid);
+
+#pragma once
+
+#include <vector>
+#include <string_view>
+#include <memory_resource>
+#include <algorithm>
+#include <cstdint>
+
+#include "mapped_file.h"
+#include "scratch_arena.h"
+
+
+class word_search {
+public:
+    explicit word_search(const std::vector<std::string_view> & words)
+    {
+        // the letters used in the words are numbered from 1; every other
+        // character is 0, which takes every state back to the start
+        std::fill(std::begin(letter_), std::end(letter_), 0);
+        for (const std::string_view word : words)
+            for (const char c : word)
+                if (letter_[static_cast<unsigned char>(c)] == 0)
+                    letter_[static_cast<unsigned char>(c)] = ++letters_;
+        ++letters_;
+
+        add_state();
+        for (const std::string_view word : words) {
+            if (word.empty())
+                continue;
+            // (a palindrome is added twice, as it's found twice, once each way)
+            add_word(word.begin(), word.end());
+            add_word(word.rbegin(), word.rend());
+        }
+        link_states();
+    }
+
+    // the number of states in the automaton
+    size_t states() const { return matches_.size(); }
+
+    // return the number of times the words appear in the given grid, reading
+    // in any of the eight directions
+    uint64_t count(const grid_view & grid) const
+    {
+        if (grid.rows == 0 || grid.columns == 0)
+            return 0;
+        scratch_arena arena;
+        // (the states of the automata running down each column, diagonal
+        // (c - r + rows - 1) and anti-diagonal (c + r))
+        std::pmr::vector<uint32_t> south(grid.columns, 0, &arena);
+        std::pmr::vector<uint32_t> south_east(grid.rows + grid.columns - 1, 0, &arena);
+        std::pmr::vector<uint32_t> south_west(grid.rows + grid.columns - 1, 0, &arena);
+
+        uint64_t total = 0;
+        for (unsigned r = 0; r < grid.rows; ++r) {
+            const char * const row = grid.text.data() + size_t(r) * grid.stride;
+            uint32_t * const diagonal = south_east.data() + grid.rows - 1 - r;
+            uint32_t * const anti_diagonal = south_west.data() + r;
+            uint32_t east = 0;
+            for (unsigned c = 0; c < grid.columns; ++c) {
+                const unsigned letter = letter_[static_cast<unsigned char>(row[c])];
+                east = step(east, letter);
+                south[c] = step(south[c], letter);
+                diagonal[c] = step(diagonal[c], letter);
+                anti_diagonal[c] = step(anti_diagonal[c], letter);
+                total += matches_[east] + matches_[south[c]] + matches_[diagonal[c]] + matches_[anti_diagonal[c]];
+            }
+        }
+        return total;
+    }
+
+private:
+    unsigned letter_[256];
+    unsigned letters_ = 0;              // (including the 0 for characters not in any word)
+    std::vector<uint32_t> next_;        // (the state after state s reads letter l is next_[s * letters_ + l])
+    std::vector<uint32_t> matches_;     // (the number of words that end on reaching each state)
+
+    uint32_t step(uint32_t state, unsigned letter) const
+    {
+        return next_[size_t(state) * letters_ + letter];
+    }
+
+    uint32_t add_state()
+    {
+        next_.resize(next_.size() + letters_, 0);
+        matches_.push_back(0);
+        return matches_.size() - 1;
+    }
+
+    // add the given word to the trie of states starting at state 0 (in
+    // which, until link_states(), a next state of 0 means none)
+    template <typename Iterator>
+    void add_word(Iterator first, Iterator last)
+    {
+        uint32_t state = 0;
+        for (; first != last; ++first) {
+            const unsigned letter = letter_[static_cast<unsigned char>(*first)];
+            if (next_[size_t(state) * letters_ + letter] == 0) {
+                const uint32_t added = add_state();
+                next_[size_t(state) * letters_ + letter] = added;
+            }
+            state = next_[size_t(state) * letters_ + letter];
+        }
+        ++matches_[state];
+    }
+
+    // turn the trie into the automaton, breadth first: each state's failure
+    // link is the state for the longest proper suffix of its string that's
+    // also in the trie; a letter with no next state in the trie goes where
+    // it would from the failure link, and a state's matches include those of
+    // its failure link
+    void link_states()
+    {
+        std::vector<uint32_t> failure(states(), 0);
+        std::vector<uint32_t> queue;
+        queue.reserve(states());
+        for (unsigned letter = 1; letter < letters_; ++letter)
+            if (const uint32_t child = step(0, letter))
+                queue.push_back(child);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            const uint32_t state = queue[i];
+            matches_[state] += matches_[failure[state]];
+            for (unsigned letter = 1; letter < letters_; ++letter) {
+                uint32_t & next = next_[size_t(state) * letters_ + letter];
+                if (next) {
+                    failure[next] = step(failure[state], letter);
+                    queue.push_back(next);
+                }
+                else
+                    next = step(failure[state], letter);
+            }
+        }
+    }
+};